@@ -14,11 +14,12 @@ Allocator::Allocator(Allocator& parent, size_t capacity) :
 }
 
 Allocator::Allocator(Allocator&& other) noexcept :
-	parent(other.parent), memory(other.memory), allocated(other.allocated), capacity(other.capacity)
+	parent(other.parent), memory(other.memory), allocated(other.allocated), peak(other.peak), capacity(other.capacity)
 {
 	other.parent = nullptr;
 	other.memory = nullptr;
 	other.allocated = 0;
+	other.peak = 0;
 	other.capacity = 0;
 }
 
@@ -30,11 +31,13 @@ Allocator& Allocator::operator=(Allocator&& other) noexcept
 	parent = other.parent;
 	memory = other.memory;
 	allocated = other.allocated;
+	peak = other.peak;
 	capacity = other.capacity;
 	
 	other.parent = nullptr;
 	other.memory = nullptr;
 	other.allocated = 0;
+	other.peak = 0;
 	other.capacity = 0;
 
 	return *this;
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <Core/Types.h>
+#include <new>
+
 struct Allocator
 {
 	Allocator() = default;
@@ -57,6 +60,16 @@ struct Allocator
 	//
 	virtual void Deallocate(void* allocation) = 0;
 
+	// Count bytes as allocated, raising the peak if needed
+	//
+	void AddAllocated(size_t size)
+	{
+		allocated += size;
+
+		if (allocated > peak)
+			peak = allocated;
+	}
+
 	// Allocator this allocator used to allocate its memory
 	//
 	Allocator* parent = nullptr;
@@ -69,6 +82,10 @@ struct Allocator
 	//
 	size_t allocated = 0;
 
+	// Highest number of bytes allocated at any one time
+	//
+	size_t peak = 0;
+
 	// Total number of bytes available
 	//
 	size_t capacity = 0;
@@ -31,7 +31,7 @@ void Assert::OnConditionFailed(const char* condition, const char* filename, int
 	va_list args;
 
 	va_start(args, message);
-	vsnprintf_s(buffer, sizeof(buffer), _TRUNCATE, message, args);
+	vsnprintf(buffer, sizeof(buffer), message, args);
 	va_end(args);
 
 	LOG_ERROR("\n%s(%i): %s (%s)\n", filename , line , buffer, condition);
@@ -47,7 +47,7 @@ void Assert::ReportFatalError(const char* filename, int line, const char* messag
 	va_list args;
 
 	va_start(args, message);
-	vsnprintf_s(buffer, sizeof(buffer), _TRUNCATE, message, args);
+	vsnprintf(buffer, sizeof(buffer), message, args);
 	va_end(args);
 
 	LOG_ERROR("\n%s(%i): %s\n", filename , line , buffer);
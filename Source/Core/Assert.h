@@ -8,7 +8,11 @@ namespace Assert
 	void ReportFatalError(const char* filename, int line, const char* message, ...);
 }
 
+#ifdef _WIN32
 #define HALT() __debugbreak()
+#else
+#define HALT() __builtin_trap()
+#endif
 
 #ifndef FINAL_BUILD
 
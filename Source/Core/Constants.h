@@ -1,8 +1,11 @@
 #pragma once
 
+#include <Core/Types.h>
+#include <limits>
+
 constexpr unsigned int ieee_positive_infinity = 0x7f800000;
 
-constexpr float infinity = float(1e+300 * 1e+300);
+constexpr float infinity = std::numeric_limits<float>::infinity();
 constexpr float epsilon = 0.000001f;
 constexpr float pi = 3.14159265358979f;
 constexpr float invpi = 0.31830988618379f;
@@ -17,6 +20,7 @@ const float rad_from_deg = pi / 180;
 
 constexpr int max_int_value = 0x7fffffff;
 constexpr int max_path_length = 255;
+constexpr int max_worker_count = 64;
 
 constexpr float operator""_deg(unsigned long long x) { return float(x * pi / 180); }
 constexpr float operator""_deg(long double x) { return float(x * pi / 180); }
@@ -16,6 +16,10 @@ namespace
 		// Unaligned memory size
 		//
 		size_t size = 0;
+
+		// Tag the allocation is accounted to
+		//
+		Memory::Tag tag = Memory::Tag::Other;
 	};
 
 	bool ValidateFreeList(const HeapAllocator::FreeBlock* head)
@@ -131,10 +135,15 @@ void* HeapAllocator::Allocate(size_t size, size_t alignment)
 
 		header->memory = unaligned;
 		header->size = total;
+		header->tag = Memory::GetTag();
 
-		// Save off stats
+		// Save off stats. Heaps carved out of another allocator are already accounted to a tag
+		// by their parent.
 		
-		allocated += total;
+		AddAllocated(total);
+
+		if (!parent)
+			Memory::OnAllocate(header->tag, total);
 
 		// Return the aligned memory
 
@@ -163,6 +172,9 @@ void HeapAllocator::Deallocate(void* ptr)
 
 	allocated -= header.size;
 
+	if (!parent)
+		Memory::OnDeallocate(header.tag, header.size);
+
 	// Mark the memory as free
 
 	Mark(header.memory, header.size, Memory::Pattern::Free);
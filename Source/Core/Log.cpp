@@ -1,10 +1,18 @@
 #include <Core/Log.h>
-#include <Windows.h>
-#include <cstdio>
 #include <Core/Assert.h>
+#include <cstdio>
+#include <cstdarg>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
 
 namespace
 {
+#ifdef _WIN32
+
 	const WORD colors[] =
 	{
 		0x08,	// Spew: Dark grey on black
@@ -61,6 +69,68 @@ namespace
 		HANDLE file = INVALID_HANDLE_VALUE;
 	};
 
+#else
+
+	const char* const colors[] =
+	{
+		"\x1b[90m",	// Spew: Dark grey
+		"\x1b[0m",		// Info: Normal
+		"\x1b[93m",	// Warning: Yellow
+		"\x1b[91m",	// Error: Red
+		"\x1b[97;41m",	// Fatal: White on red
+	};
+
+	struct LogSystem
+	{
+		LogSystem(const char* path, Severity filter) : filter(filter)
+		{
+			file = fopen(path, "a");
+			colored = isatty(STDOUT_FILENO) && isatty(STDERR_FILENO);
+		}
+
+		LogSystem(const LogSystem&) = delete;
+		void operator=(const LogSystem&) = delete;
+
+		LogSystem(LogSystem&&) = delete;
+		void operator=(LogSystem&&) = delete;
+
+		~LogSystem()
+		{
+			if (file)
+				fclose(file);
+		}
+
+		void LogMessage(Severity severity, const char* message, size_t length)
+		{
+			FILE* console = severity == Severity::Error ? stderr : stdout;
+
+			if (file)
+			{
+				fwrite(message, 1, length, file);
+				fflush(file);
+			}
+
+			if (colored)
+				fprintf(console, "%s%.*s%s", colors[int(severity)], int(length), message, colors[int(Severity::Info)]);
+			else
+				fwrite(message, 1, length, console);
+		}
+
+		// Current log filter level (messages >= will pass)
+		//
+		Severity filter = Severity::Info;
+
+		// True if the console understands ANSI color codes
+		//
+		bool colored = false;
+
+		// Log file
+		//
+		FILE* file = nullptr;
+	};
+
+#endif
+
 	LogSystem* log = nullptr;
 }
 
@@ -86,7 +156,7 @@ void Log::LogMessage(Severity severity, const char* message, ...)
 	va_list values;
 
 	va_start(values, message);
-	const size_t length = vsprintf_s(buffer, message, values);
+	const size_t length = vsnprintf(buffer, sizeof(buffer), message, values);
 	va_end(values);
 
 	ASSERT(length >= 0 && length < sizeof(buffer) - 1);
@@ -1,12 +1,62 @@
 #include <Core/Memory.h>
 #include <Core/Constants.h>
 #include <Core/HeapAllocator.h>
+#include <Core/SharedAllocator.h>
+#include <Core/SpinLock.h>
+#include <Core/Assert.h>
+#include <Core/Log.h>
+#include <atomic>
 #include <cstring>
 
+namespace
+{
+	constexpr int max_registered = 16;
+
+	const char* const tag_names[] = { "Other", "Textures", "Framebuffers", "AOVs", "Scratch", "Profiling" };
+
+	static_assert(countof(tag_names) == int(Memory::Tag::Count), "Missing tag names");
+
+	struct Usage
+	{
+		std::atomic<size_t> current = { 0 };
+		std::atomic<size_t> peak = { 0 };
+	};
+
+	struct Registered
+	{
+		const char* name = nullptr;
+		const Allocator* allocator = nullptr;
+	};
+
+	Usage usage[int(Memory::Tag::Count)];
+
+	thread_local Memory::Tag current_tag = Memory::Tag::Other;
+
+	std::atomic_flag registry_lock = ATOMIC_FLAG_INIT;
+	Registered registry[max_registered];
+	int registered_count = 0;
+
+	float ToMiB(size_t size)
+	{
+		return size / float(1_MiB);
+	}
+}
+
+Memory::TagScope::TagScope(Tag tag) : previous(current_tag)
+{
+	current_tag = tag;
+}
+
+Memory::TagScope::~TagScope()
+{
+	current_tag = previous;
+}
+
 Allocator& Memory::TempAllocator()
 {
 	static char memory[100_MiB] = {};
-	static HeapAllocator allocator(memory, sizeof(memory));
+	static HeapAllocator heap(memory, sizeof(memory));
+	static SharedAllocator allocator(heap);
 
 	return allocator;
 }
@@ -20,3 +70,105 @@ void Memory::Mark(void* memory, size_t size, Pattern pattern)
 {
 	memset(memory, pattern, size);
 }
+
+Memory::Tag Memory::GetTag()
+{
+	return current_tag;
+}
+
+const char* Memory::GetTagName(Tag tag)
+{
+	return tag_names[int(tag)];
+}
+
+void Memory::OnAllocate(Tag tag, size_t size)
+{
+	Usage& tagged = usage[int(tag)];
+
+	const size_t current = tagged.current.fetch_add(size, std::memory_order_relaxed) + size;
+
+	size_t peak = tagged.peak.load(std::memory_order_relaxed);
+
+	while (current > peak && !tagged.peak.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+		;
+}
+
+void Memory::OnDeallocate(Tag tag, size_t size)
+{
+	usage[int(tag)].current.fetch_sub(size, std::memory_order_relaxed);
+}
+
+size_t Memory::GetTagged(Tag tag)
+{
+	return usage[int(tag)].current.load(std::memory_order_relaxed);
+}
+
+size_t Memory::GetTaggedPeak(Tag tag)
+{
+	return usage[int(tag)].peak.load(std::memory_order_relaxed);
+}
+
+void Memory::ResetTaggedPeaks()
+{
+	for (Usage& tagged : usage)
+		tagged.peak.store(tagged.current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void Memory::Register(const char* name, const Allocator& allocator)
+{
+	SpinLock locked(registry_lock);
+
+	ASSERT(registered_count < max_registered, "Too many allocators registered for the memory report");
+
+	if (registered_count < max_registered)
+		registry[registered_count++] = { name, &allocator };
+}
+
+void Memory::Unregister(const Allocator& allocator)
+{
+	SpinLock locked(registry_lock);
+
+	for (int i = 0; i < registered_count; ++i)
+	{
+		if (registry[i].allocator == &allocator)
+		{
+			registry[i] = registry[--registered_count];
+			return;
+		}
+	}
+}
+
+void Memory::LogReport()
+{
+	LOG_INFO("Memory:");
+
+	{
+		SpinLock locked(registry_lock);
+
+		for (int i = 0; i < registered_count; ++i)
+		{
+			const Allocator& allocator = *registry[i].allocator;
+
+			LOG_INFO("  %-12s allocated = %8.2f MiB, peak = %8.2f MiB, capacity = %8.2f MiB", registry[i].name, ToMiB(allocator.allocated), ToMiB(allocator.peak), ToMiB(allocator.capacity));
+		}
+	}
+
+	size_t current_total = 0;
+	size_t peak_total = 0;
+
+	for (int i = 0; i < int(Tag::Count); ++i)
+	{
+		const size_t current = GetTagged(Tag(i));
+		const size_t peak = GetTaggedPeak(Tag(i));
+
+		if (peak == 0)
+			continue;
+
+		LOG_INFO("  %-12s current   = %8.2f MiB, peak = %8.2f MiB", tag_names[i], ToMiB(current), ToMiB(peak));
+
+		current_total += current;
+		peak_total += peak;
+	}
+
+	LOG_INFO("Tagged: current = %.2f MiB, sum of peaks = %.2f MiB", ToMiB(current_total), ToMiB(peak_total));
+}
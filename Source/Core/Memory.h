@@ -13,7 +13,36 @@ namespace Memory
 		Free = 0xdd
 	};
 
-	// Allocator for short-lived allocations
+	// Categories that memory is accounted to, so the report shows what it's used for
+	//
+	enum class Tag : uint8_t
+	{
+		Other,
+		Textures,
+		Framebuffers,
+		Aovs,
+		Scratch,
+		Profiling,
+		Count
+	};
+
+	// Accounts allocations made on the current thread to a tag until the scope ends
+	//
+	struct TagScope
+	{
+		TagScope(Tag tag);
+		~TagScope();
+
+		TagScope(const TagScope&) = delete;
+		void operator=(const TagScope&) = delete;
+
+		// Tag to go back to when the scope ends
+		//
+		Tag previous;
+	};
+
+	// Allocator for short-lived allocations. It's safe to use from any thread, but worker
+	// threads should use a ScratchScope for buffers that only last for a call.
 	//
 	Allocator& TempAllocator();
 
@@ -24,4 +53,37 @@ namespace Memory
 	// Mark the memory with the supplied pattern
 	//
 	void Mark(void* memory, size_t size, Pattern pattern);
+
+	// Return the tag that allocations on the current thread are accounted to
+	//
+	Tag GetTag();
+
+	// Return the name of a tag
+	//
+	const char* GetTagName(Tag tag);
+
+	// Account bytes to a tag. Heaps that own their memory do this for every allocation, so
+	// these only need calling for memory that comes from elsewhere.
+	//
+	void OnAllocate(Tag tag, size_t size);
+	void OnDeallocate(Tag tag, size_t size);
+
+	// Return the bytes accounted to a tag now, and the most there have been at once
+	//
+	size_t GetTagged(Tag tag);
+	size_t GetTaggedPeak(Tag tag);
+
+	// Lower the peak for every tag to the bytes accounted to it now, so that the peaks cover
+	// only what happens from here on
+	//
+	void ResetTaggedPeaks();
+
+	// Add an allocator to the report under a name, until it's unregistered
+	//
+	void Register(const char* name, const Allocator& allocator);
+	void Unregister(const Allocator& allocator);
+
+	// Log the current and peak memory of the registered allocators and each tag
+	//
+	void LogReport();
 }
\ No newline at end of file
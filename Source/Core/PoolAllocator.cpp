@@ -0,0 +1,485 @@
+#include <Core/PoolAllocator.h>
+#include <Core/Assert.h>
+#include <Core/Memory.h>
+#include <Core/SpinLock.h>
+
+struct PoolAllocator::Block
+{
+	// Next free block in the span
+	//
+	Block* next = nullptr;
+};
+
+struct PoolAllocator::Span
+{
+	// Size class of the blocks, or large_class for a span holding a single large allocation
+	//
+	int size_class = 0;
+
+	// Number of blocks handed out, less those freed by other threads that have been collected
+	//
+	int used = 0;
+
+	// Bytes taken from the parent allocator
+	//
+	size_t size = 0;
+
+	// Cache whose thread allocates from the span
+	//
+	ThreadCache* owner = nullptr;
+
+	// Blocks freed by the owner
+	//
+	Block* free = nullptr;
+
+	// Start of the blocks that have never been handed out
+	//
+	uint8_t* unused = nullptr;
+
+	// Blocks freed by other threads, waiting for the owner to collect them
+	//
+	std::atomic<Block*> remote = { nullptr };
+
+	// Neighbours in the owner's list of spans for the size class
+	//
+	Span* prev = nullptr;
+	Span* next = nullptr;
+};
+
+struct PoolAllocator::ThreadCache
+{
+	// Spans for each size class, allocating from the first span that has a free block
+	//
+	Span* spans[class_count] = {};
+
+	// Set while a thread is using the cache
+	//
+	bool bound = false;
+
+	// Next cache created by the allocator
+	//
+	ThreadCache* next = nullptr;
+};
+
+namespace
+{
+	constexpr int large_class = -1;
+	constexpr int max_bindings = 8;
+	constexpr size_t span_header_size = 256;
+
+	static_assert(sizeof(PoolAllocator::Span) <= span_header_size, "Span header doesn't fit in front of the blocks");
+	static_assert(span_header_size % PoolAllocator::small_alignment_limit == 0, "Blocks must start aligned");
+
+	struct Binding
+	{
+		PoolAllocator* allocator = nullptr;
+		unsigned int id = 0;
+		PoolAllocator::ThreadCache* cache = nullptr;
+	};
+
+	// Allocators that haven't been destroyed, so that exiting threads only release caches that
+	// still exist
+
+	std::atomic_flag live_lock = ATOMIC_FLAG_INIT;
+	PoolAllocator* live = nullptr;
+	unsigned int live_id = 0;
+
+	bool IsLive(const Binding& binding)
+	{
+		for (const PoolAllocator* allocator = live; allocator; allocator = allocator->next_live)
+		{
+			if (allocator == binding.allocator && allocator->id == binding.id)
+				return true;
+		}
+
+		return false;
+	}
+
+	// Caches used by the current thread. These have no destructor, so looking them up doesn't
+	// go through the check that registers thread exit handlers.
+
+	struct ThreadBindings
+	{
+		Binding bindings[max_bindings];
+		int count = 0;
+	};
+
+	thread_local ThreadBindings thread_bindings;
+
+	// Releases the caches of the current thread for other threads to adopt when it exits
+	//
+	struct ThreadExit
+	{
+		~ThreadExit()
+		{
+			SpinLock locked(live_lock);
+
+			for (int i = 0; i < thread_bindings.count; ++i)
+			{
+				const Binding& binding = thread_bindings.bindings[i];
+
+				if (IsLive(binding))
+				{
+					SpinLock cache_locked(binding.allocator->lock);
+
+					binding.cache->bound = false;
+				}
+			}
+		}
+
+		bool registered = false;
+	};
+
+	thread_local ThreadExit thread_exit;
+
+	PoolAllocator::ThreadCache* FindCache(const PoolAllocator& allocator)
+	{
+		for (int i = 0; i < thread_bindings.count; ++i)
+		{
+			const Binding& binding = thread_bindings.bindings[i];
+
+			if (binding.allocator == &allocator && binding.id == allocator.id)
+				return binding.cache;
+		}
+
+		return nullptr;
+	}
+
+#if defined(DEBUG_BUILD)
+	void MarkBlock(void* memory, size_t size, Memory::Pattern pattern)
+	{
+		Memory::Mark(memory, size, pattern);
+	}
+#else
+	void MarkBlock(void*, size_t, Memory::Pattern)
+	{
+	}
+#endif
+
+	// Sizes up to 128 bytes are in steps of 16, and above that each doubling is split into
+	// four classes, so no more than a fifth of a block is wasted
+
+	constexpr size_t CalculateClassSize(int size_class)
+	{
+		return size_class < 8 ?
+			size_t(size_class + 1) * 16 :
+			(size_t(1) << (7 + (size_class - 8) / 4)) + size_t((size_class - 8) % 4 + 1) * (size_t(1) << (5 + (size_class - 8) / 4));
+	}
+
+	struct ClassSizes
+	{
+		constexpr ClassSizes()
+		{
+			for (int i = 0; i < PoolAllocator::class_count; ++i)
+				sizes[i] = CalculateClassSize(i);
+		}
+
+		size_t sizes[PoolAllocator::class_count] = {};
+	};
+
+	constexpr ClassSizes class_sizes;
+
+	static_assert(CalculateClassSize(PoolAllocator::class_count - 1) == PoolAllocator::small_size_limit, "Largest size class doesn't match the small size limit");
+}
+
+PoolAllocator::PoolAllocator(Allocator& pages) : pages(pages)
+{
+	SpinLock locked(live_lock);
+
+	id = ++live_id;
+	next_live = live;
+	live = this;
+}
+
+PoolAllocator::~PoolAllocator()
+{
+	{
+		SpinLock locked(live_lock);
+
+		PoolAllocator** link = &live;
+		while (*link != this)
+			link = &(*link)->next_live;
+		*link = next_live;
+	}
+
+	ASSERT(large_count == 0, "Pool has %i outstanding large allocations", large_count);
+
+	while (ThreadCache* cache = caches)
+	{
+		for (Span* span : cache->spans)
+		{
+			while (span)
+			{
+				for (Block* block = span->remote.exchange(nullptr); block; block = block->next)
+					--span->used;
+
+				ASSERT(span->used == 0, "Pool has %i outstanding allocations of %llu bytes", span->used, (unsigned long long)GetClassSize(span->size_class));
+
+				Span* next = span->next;
+				pages.Deallocate(span);
+				span = next;
+			}
+		}
+
+		caches = cache->next;
+		pages.Delete(cache);
+	}
+
+	allocated = 0;
+}
+
+void* PoolAllocator::Allocate(size_t size, size_t alignment)
+{
+	if (size == 0)
+		return nullptr;
+
+	const int size_class = GetSizeClass(size, alignment);
+
+	// Large allocations get a span of their own, with the allocation after the header
+
+	if (size_class == large_class)
+	{
+		ASSERT(alignment < span_size, "Pool allocations must be aligned to less than the span size");
+
+		const size_t offset = alignment > span_header_size ? alignment : span_header_size;
+
+		SpinLock locked(lock);
+
+		Span* span = new (pages.Allocate(offset + size, span_size)) Span();
+		span->size_class = large_class;
+		span->size = offset + size;
+		span->used = 1;
+
+		AddAllocated(span->size);
+		++large_count;
+
+		return reinterpret_cast<uint8_t*>(span) + offset;
+	}
+
+	// Bind the thread to a cache the first time it allocates
+
+	ThreadCache* cache = FindCache(*this);
+
+	if (!cache)
+	{
+		{
+			SpinLock locked(live_lock);
+
+			ThreadBindings& bindings = thread_bindings;
+
+			for (int i = 0; i < bindings.count;)
+			{
+				if (IsLive(bindings.bindings[i]))
+					++i;
+				else
+					bindings.bindings[i] = bindings.bindings[--bindings.count];
+			}
+
+			CRITICAL(bindings.count < max_bindings, "Thread is using more than %i pool allocators", max_bindings);
+		}
+
+		SpinLock locked(lock);
+
+		for (cache = caches; cache && cache->bound; cache = cache->next)
+			;
+
+		if (!cache)
+		{
+			cache = pages.New<ThreadCache>();
+			cache->next = caches;
+			caches = cache;
+		}
+
+		cache->bound = true;
+
+		thread_exit.registered = true;
+
+		Binding& binding = thread_bindings.bindings[thread_bindings.count++];
+		binding.allocator = this;
+		binding.id = id;
+		binding.cache = cache;
+	}
+
+	// Allocate from the first span with a free block, moving it to the front of the list so
+	// that the next allocation finds it straight away
+
+	const size_t block_size = class_sizes.sizes[size_class];
+	Span*& head = cache->spans[size_class];
+
+	for (Span* span = head; span; span = span->next)
+	{
+		Block* block = span->free;
+
+		if (block)
+		{
+			span->free = block->next;
+		}
+		else if (span->remote.load(std::memory_order_relaxed))
+		{
+			block = span->remote.exchange(nullptr, std::memory_order_acquire);
+			span->free = block->next;
+
+			for (Block* collected = block; collected; collected = collected->next)
+				--span->used;
+		}
+		else if (span->unused + block_size <= reinterpret_cast<uint8_t*>(span) + span_size)
+		{
+			block = reinterpret_cast<Block*>(span->unused);
+			span->unused += block_size;
+		}
+		else
+		{
+			continue;
+		}
+
+		++span->used;
+
+		if (span != head)
+		{
+			span->prev->next = span->next;
+			if (span->next)
+				span->next->prev = span->prev;
+
+			span->prev = nullptr;
+			span->next = head;
+			head->prev = span;
+			head = span;
+		}
+
+		MarkBlock(block, block_size, Memory::Pattern::Allocated);
+
+		return block;
+	}
+
+	// All the spans are full, so take a new one
+
+	Span* span;
+
+	{
+		SpinLock locked(lock);
+
+		span = new (pages.Allocate(span_size, span_size)) Span();
+
+		AddAllocated(span_size);
+		++span_count;
+	}
+
+	span->size_class = size_class;
+	span->size = span_size;
+	span->owner = cache;
+	span->unused = reinterpret_cast<uint8_t*>(span) + span_header_size + block_size;
+	span->used = 1;
+	span->next = head;
+
+	if (head)
+		head->prev = span;
+	head = span;
+
+	void* block = reinterpret_cast<uint8_t*>(span) + span_header_size;
+
+	MarkBlock(block, block_size, Memory::Pattern::Allocated);
+
+	return block;
+}
+
+void PoolAllocator::Deallocate(void* allocation)
+{
+	if (!allocation)
+		return;
+
+	Span* span = reinterpret_cast<Span*>(uintptr_t(allocation) & ~(span_size - 1));
+
+	if (span->size_class == large_class)
+	{
+		SpinLock locked(lock);
+
+		ASSERT(large_count > 0, "Deallocating a large allocation that wasn't allocated");
+
+		allocated -= span->size;
+		--large_count;
+
+		pages.Deallocate(span);
+		return;
+	}
+
+	const size_t block_size = class_sizes.sizes[span->size_class];
+
+	MarkBlock(allocation, block_size, Memory::Pattern::Free);
+
+	Block* block = static_cast<Block*>(allocation);
+	ThreadCache* cache = FindCache(*this);
+
+	// Blocks from another thread's span are pushed for the owner to collect
+
+	if (span->owner != cache)
+	{
+		Block* remote = span->remote.load(std::memory_order_relaxed);
+
+		do
+			block->next = remote;
+		while (!span->remote.compare_exchange_weak(remote, block, std::memory_order_release, std::memory_order_relaxed));
+
+		return;
+	}
+
+	block->next = span->free;
+	span->free = block;
+
+	// Return spans that have been emptied by their owner to the parent, keeping the first one
+	// so that a thread that allocates and frees a single block doesn't map a span each time.
+	// Spans emptied by other threads are kept for the owner to reuse.
+
+	Span*& head = cache->spans[span->size_class];
+
+	if (--span->used == 0 && span != head)
+	{
+		span->prev->next = span->next;
+		if (span->next)
+			span->next->prev = span->prev;
+
+		SpinLock locked(lock);
+
+		allocated -= span_size;
+		--span_count;
+
+		pages.Deallocate(span);
+	}
+}
+
+int PoolAllocator::GetSizeClass(size_t size, size_t alignment)
+{
+	ASSERT(alignment != 0 && (alignment & (alignment - 1)) == 0, "Alignment %llu isn't a power of two", (unsigned long long)alignment);
+
+	if (size > small_size_limit || alignment > small_alignment_limit)
+		return large_class;
+
+	int size_class;
+
+	if (size <= 128)
+	{
+		size_class = int((size + 15) / 16) - 1;
+	}
+	else
+	{
+		int power = 7;
+		while ((size - 1) >> (power + 1))
+			++power;
+
+		size_class = 8 + (power - 7) * 4 + int(((size - 1) - (size_t(1) << power)) >> (power - 2));
+	}
+
+	// Blocks are packed from an aligned offset in the span, so over-aligned allocations move up
+	// to a class whose size is a multiple of the alignment
+
+	while (class_sizes.sizes[size_class] & (alignment - 1))
+		++size_class;
+
+	return size_class;
+}
+
+size_t PoolAllocator::GetClassSize(int size_class)
+{
+	ASSERT(size_class >= 0 && size_class < class_count, "Invalid size class %i", size_class);
+
+	return class_sizes.sizes[size_class];
+}
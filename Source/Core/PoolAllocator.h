@@ -0,0 +1,81 @@
+#pragma once
+
+#include <Core/Allocator.h>
+#include <atomic>
+
+// Allocator for many small allocations from many threads. Allocations are rounded up to one
+// of a fixed set of size classes, and each size class is carved out of 64 KiB spans taken
+// from the parent allocator. Each thread allocates from spans owned by its own cache, so the
+// common path takes no lock. Memory freed by another thread is pushed onto the span without
+// locking and collected by the owner the next time it runs out of blocks. Allocations that
+// are too large for a size class are given their own span straight from the parent.
+//
+struct PoolAllocator : Allocator
+{
+	struct Block;
+	struct Span;
+	struct ThreadCache;
+
+	// Number of size classes, from 16 bytes to small_size_limit
+	//
+	static constexpr int class_count = 32;
+
+	// Size of the spans the size classes are carved from, also their alignment
+	//
+	static constexpr size_t span_size = 64 * 1024;
+
+	// Largest allocation that is rounded up to a size class
+	//
+	static constexpr size_t small_size_limit = 8 * 1024;
+
+	// Largest alignment that is satisfied by a size class
+	//
+	static constexpr size_t small_alignment_limit = 256;
+
+	// The parent must be able to align allocations to span_size, and is only used under the
+	// allocator lock, so it doesn't need to be thread safe
+	//
+	PoolAllocator(Allocator& pages);
+	~PoolAllocator();
+
+	// Allocate raw aligned memory
+	//
+	void* Allocate(size_t size, size_t alignment) override;
+
+	// Deallocate memory allocated by any thread
+	//
+	void Deallocate(void* allocation) override;
+
+	// Return the size class for the allocation, or -1 if it needs a span of its own
+	//
+	static int GetSizeClass(size_t size, size_t alignment);
+
+	// Return the size of the blocks in a size class
+	//
+	static size_t GetClassSize(int size_class);
+
+	// Allocator the spans are taken from
+	//
+	Allocator& pages;
+
+	// Caches created for threads, including those left behind by threads that have exited
+	//
+	ThreadCache* caches = nullptr;
+
+	// Number of spans held by the caches, and the number of large allocations
+	//
+	int span_count = 0;
+	int large_count = 0;
+
+	// Unique identifier, so threads can tell a new allocator from one destroyed at the same address
+	//
+	unsigned int id = 0;
+
+	// Next live allocator in the list checked by exiting threads
+	//
+	PoolAllocator* next_live = nullptr;
+
+	// Guards the parent allocator, the cache list and the counts
+	//
+	std::atomic_flag lock = ATOMIC_FLAG_INIT;
+};
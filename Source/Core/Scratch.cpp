@@ -0,0 +1,83 @@
+#include <Core/Scratch.h>
+#include <Core/Constants.h>
+#include <Core/Pointer.h>
+#include <Core/Generic.h>
+#include <Core/Memory.h>
+#include <vector>
+
+namespace
+{
+	// Smallest block to request, big enough for a 64 x 64 tile of sample sums and its texels
+	//
+	constexpr size_t min_block_size = 1_MiB;
+
+	// Blocks are never freed or moved, so allocations stay valid as more blocks are added
+	//
+	struct Arena
+	{
+		~Arena()
+		{
+			for (const std::vector<uint8_t>& memory : blocks)
+				Memory::OnDeallocate(Memory::Tag::Scratch, memory.size());
+		}
+
+		std::vector<std::vector<uint8_t>> blocks;
+
+		// Block being allocated from, and the offset of the next allocation in it
+		//
+		int block = 0;
+		size_t offset = 0;
+	};
+
+	thread_local Arena arena;
+}
+
+ScratchScope::ScratchScope() : block(arena.block), offset(arena.offset)
+{
+}
+
+ScratchScope::~ScratchScope()
+{
+	arena.block = block;
+	arena.offset = offset;
+}
+
+void ScratchScope::Deallocate(void*)
+{
+}
+
+void* ScratchScope::Allocate(size_t size, size_t alignment)
+{
+	// Move on to the next block that can fit the allocation, adding one if there are none left.
+	// Blocks passed over are left unused until the scope that moved past them ends.
+
+	for (;;)
+	{
+		if (arena.block < int(arena.blocks.size()))
+		{
+			std::vector<uint8_t>& memory = arena.blocks[arena.block];
+
+			uint8_t* begin = memory.data();
+			uint8_t* allocation = Pointer::Align(begin + arena.offset, alignment);
+
+			if (size_t(allocation - begin) + size <= memory.size())
+			{
+				arena.offset = size_t(allocation - begin) + size;
+				AddAllocated(size);
+				return allocation;
+			}
+
+			if (arena.block + 1 < int(arena.blocks.size()))
+			{
+				++arena.block;
+				arena.offset = 0;
+				continue;
+			}
+		}
+
+		arena.blocks.emplace_back(Max(size + alignment, min_block_size));
+		Memory::OnAllocate(Memory::Tag::Scratch, arena.blocks.back().size());
+		arena.block = int(arena.blocks.size()) - 1;
+		arena.offset = 0;
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <Core/Allocator.h>
+
+// Scratch memory private to the calling thread, for buffers that only live for the duration of
+// a call such as the texels of a tile. Allocations are released in stack order when the scope
+// that made them ends. Each thread keeps its memory for reuse, so once a thread has seen its
+// largest tile no more memory is requested.
+//
+// Scopes are also allocators, so that arrays and images can be made from them at bump pointer
+// cost. Arrays from NewArray don't need to be deleted, as long as their type doesn't need a
+// destructor.
+//
+struct ScratchScope : Allocator
+{
+	ScratchScope();
+	~ScratchScope() override;
+
+	// Allocate raw aligned memory that lasts until the end of the scope
+	//
+	void* Allocate(size_t size, size_t alignment) override;
+
+	// Memory is only released when the scope ends
+	//
+	void Deallocate(void* allocation) override;
+
+	// Position in the thread's scratch memory to return to when the scope ends
+	//
+	int block = 0;
+	size_t offset = 0;
+};
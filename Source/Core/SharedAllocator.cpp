@@ -0,0 +1,29 @@
+#include <Core/SharedAllocator.h>
+#include <Core/SpinLock.h>
+
+SharedAllocator::SharedAllocator(Allocator& allocator) : allocator(allocator)
+{
+	memory = allocator.memory;
+	capacity = allocator.capacity;
+}
+
+void* SharedAllocator::Allocate(size_t size, size_t alignment)
+{
+	SpinLock locked(lock);
+
+	void* allocation = allocator.Allocate(size, alignment);
+
+	allocated = allocator.allocated;
+	peak = allocator.peak;
+
+	return allocation;
+}
+
+void SharedAllocator::Deallocate(void* allocation)
+{
+	SpinLock locked(lock);
+
+	allocator.Deallocate(allocation);
+
+	allocated = allocator.allocated;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <Core/Allocator.h>
+#include <atomic>
+
+// Allocator that can be used from any thread, by locking around another allocator. The lock
+// is only held for the allocation itself, so a spin lock is used rather than an OS mutex.
+//
+struct SharedAllocator : Allocator
+{
+	SharedAllocator(Allocator& allocator);
+
+	// Allocate raw aligned memory
+	//
+	void* Allocate(size_t size, size_t alignment) override;
+
+	// Deallocate memory
+	//
+	void Deallocate(void* allocation) override;
+
+	// Allocator shared between the threads
+	//
+	Allocator& allocator;
+
+	// Set while a thread is using the allocator
+	//
+	std::atomic_flag lock = ATOMIC_FLAG_INIT;
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+// Scoped lock on an atomic flag, for locks that are only held for a few instructions so that
+// an OS mutex would cost more than the work it guards.
+//
+struct SpinLock
+{
+	SpinLock(std::atomic_flag& flag) : flag(flag)
+	{
+		while (flag.test_and_set(std::memory_order_acquire))
+			std::this_thread::yield();
+	}
+
+	SpinLock(const SpinLock&) = delete;
+	void operator=(const SpinLock&) = delete;
+
+	~SpinLock()
+	{
+		flag.clear(std::memory_order_release);
+	}
+
+	std::atomic_flag& flag;
+};
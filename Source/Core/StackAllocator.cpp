@@ -32,7 +32,7 @@ void* StackAllocator::Allocate(size_t size, size_t alignment)
 	Mark(allocation, size, Memory::Pattern::Allocated);
 
 	head = Pointer::Offset(allocation, size);
-	allocated += size;
+	AddAllocated(size);
 
 	return allocation;
 }
@@ -3,18 +3,31 @@
 #include <cstdio>
 #include <cstring>
 
+#ifndef _WIN32
+#include <strings.h>
+#endif
+
 size_t String::Format(char* buffer, size_t size, const char* format, ...)
 {
 	va_list values;
 
 	va_start(values, format);
-	const int formatted_size = vsnprintf_s(buffer, size, _TRUNCATE, format, values);
+	const int formatted_size = vsnprintf(buffer, size, format, values);
 	va_end(values);
 
-	return formatted_size < 0 ? size : formatted_size;
+	return formatted_size < 0 || size_t(formatted_size) >= size ? size : formatted_size;
 }
 
 void String::Copy(char* target, const char* source, size_t count)
 {
 	strncpy(target, source, count);
+}
+
+int String::CompareNoCase(const char* a, const char* b)
+{
+#ifdef _WIN32
+	return _stricmp(a, b);
+#else
+	return strcasecmp(a, b);
+#endif
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <Core/Types.h>
+
 namespace String
 {
 	// Printf-style formatting to a buffer. Returns the formatted size on success, and size on error.
@@ -9,4 +11,8 @@ namespace String
 	// Copy
 	//
 	void Copy(char* target, const char* source, size_t count);
+
+	// Case-insensitive comparison, returning <0, 0 or >0 like strcmp
+	//
+	int CompareNoCase(const char* a, const char* b);
 };
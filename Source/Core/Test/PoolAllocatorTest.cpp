@@ -0,0 +1,157 @@
+#include <Core/PoolAllocator.h>
+#include <Core/HeapAllocator.h>
+#include <Core/Constants.h>
+#include <UnitTest++/UnitTest++.h>
+#include <thread>
+
+namespace
+{
+	// Memory for the spans. Aligning each span to its size can waste almost as much again in
+	// the heap, so there's room for a span in every size class.
+	//
+	alignas(PoolAllocator::span_size) char memory[4_MiB];
+
+	// Pool over a heap of its own, so that every test starts from nothing
+	//
+	struct Pool
+	{
+		Pool() : heap(memory, sizeof(memory)), pool(heap)
+		{
+		}
+
+		HeapAllocator heap;
+		PoolAllocator pool;
+	};
+
+	uintptr_t GetSpan(const void* allocation)
+	{
+		return uintptr_t(allocation) & ~(PoolAllocator::span_size - 1);
+	}
+
+	bool IsAligned(const void* allocation, size_t alignment)
+	{
+		return (uintptr_t(allocation) & (alignment - 1)) == 0;
+	}
+}
+
+SUITE(PoolAllocator)
+{
+	TEST(SizeClassesRoundUpToTheSmallestFit)
+	{
+		// Every size goes to the smallest class that holds it and is a multiple of the alignment
+
+		int failures = 0;
+
+		for (size_t alignment = 1; alignment <= PoolAllocator::small_alignment_limit; alignment *= 2)
+		{
+			for (size_t size = 1; size <= PoolAllocator::small_size_limit; ++size)
+			{
+				const int size_class = PoolAllocator::GetSizeClass(size, alignment);
+				const size_t class_size = PoolAllocator::GetClassSize(size_class);
+
+				const bool fits = class_size >= size && class_size % alignment == 0;
+				const bool smallest = size_class == 0 || PoolAllocator::GetClassSize(size_class - 1) < size || PoolAllocator::GetClassSize(size_class - 1) % alignment != 0;
+
+				if (!fits || !smallest)
+					++failures;
+			}
+		}
+
+		CHECK_EQUAL(0, failures);
+
+		CHECK_EQUAL(-1, PoolAllocator::GetSizeClass(PoolAllocator::small_size_limit + 1, 16));
+		CHECK_EQUAL(-1, PoolAllocator::GetSizeClass(16, PoolAllocator::small_alignment_limit * 2));
+	}
+
+#ifndef FINAL_BUILD
+	TEST(AlignmentMustBeAPowerOfTwo)
+	{
+		CHECK_ASSERT(PoolAllocator::GetSizeClass(16, 0));
+		CHECK_ASSERT(PoolAllocator::GetSizeClass(16, 24));
+	}
+#endif
+
+	TEST(AllocationsAreAligned)
+	{
+		Pool pool;
+
+		void* allocations[PoolAllocator::class_count * 2];
+		int count = 0;
+
+		for (size_t alignment = 1; alignment <= PoolAllocator::small_alignment_limit; alignment *= 4)
+		{
+			for (size_t size = 24; size <= PoolAllocator::small_size_limit; size *= 3)
+			{
+				void* allocation = pool.pool.Allocate(size, alignment);
+
+				CHECK(IsAligned(allocation, alignment));
+
+				allocations[count++] = allocation;
+			}
+		}
+
+		for (int i = 0; i < count; ++i)
+			pool.pool.Deallocate(allocations[i]);
+	}
+
+	TEST(RemoteFreeIsCollectedByTheOwner)
+	{
+		Pool pool;
+
+		void* first = pool.pool.Allocate(64, 16);
+		void* second = pool.pool.Allocate(64, 16);
+
+		// Free the first block from another thread, which pushes it onto the span for the owner
+
+		std::thread([&]() { pool.pool.Deallocate(first); }).join();
+
+		// The owner takes the pushed block back before carving out new ones
+
+		void* reused = pool.pool.Allocate(64, 16);
+
+		CHECK_EQUAL(first, reused);
+		CHECK_EQUAL(1, pool.pool.span_count);
+
+		pool.pool.Deallocate(reused);
+		pool.pool.Deallocate(second);
+	}
+
+	TEST(CacheIsAdoptedAfterItsThreadExits)
+	{
+		Pool pool;
+
+		void* remote = nullptr;
+
+		std::thread([&]() { remote = pool.pool.Allocate(256, 16); }).join();
+
+		// This thread takes over the cache the other thread left behind rather than making one
+		// with a span of its own, so it allocates from the same span
+
+		void* local = pool.pool.Allocate(256, 16);
+
+		CHECK_EQUAL(GetSpan(remote), GetSpan(local));
+		CHECK_EQUAL(1, pool.pool.span_count);
+
+		pool.pool.Deallocate(remote);
+		pool.pool.Deallocate(local);
+	}
+
+	TEST(LargeAllocationsGetTheirOwnSpan)
+	{
+		Pool pool;
+
+		void* large = pool.pool.Allocate(PoolAllocator::small_size_limit + 1, 16);
+		void* aligned = pool.pool.Allocate(64, 4096);
+
+		CHECK(large && aligned);
+		CHECK(IsAligned(aligned, 4096));
+		CHECK_EQUAL(2, pool.pool.large_count);
+		CHECK_EQUAL(0, pool.pool.span_count);
+
+		pool.pool.Deallocate(large);
+		pool.pool.Deallocate(aligned);
+
+		CHECK_EQUAL(0, pool.pool.large_count);
+		CHECK_EQUAL(0u, pool.pool.allocated);
+	}
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#ifdef _WIN32
+
 using int8_t = signed char;
 using uint8_t = unsigned char;
 using int16_t = signed short;
@@ -23,6 +25,15 @@ using ptrdiff_t = signed int;
 
 #endif
 
+#else
+
+#include <cstddef>
+#include <cstdint>
+
+using ptr_t = uintptr_t;
+
+#endif
+
 using uint = unsigned int;
 
 #define countof(X) int(sizeof(X) / sizeof(X[0]))
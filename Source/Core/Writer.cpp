@@ -98,7 +98,7 @@ void Writer::WriteString(const char* format, ...)
 	va_list values;
 
 	va_start(values, format);
-	const size_t length = vsprintf_s(buffer, format, values);
+	const size_t length = vsnprintf(buffer, sizeof(buffer), format, values);
 	va_end(values);
 
 	ASSERT(length <= size_t(end - head));
@@ -9,6 +9,10 @@ struct Image
 	Image() = default;
 	Image(Allocator& allocator, int w, int h) : allocator(&allocator), texels(allocator.NewArray<T>(w * h)), w(w), h(h) {}
 
+	// Take ownership of texels allocated from the allocator, leaving their contents as they are
+	//
+	Image(Allocator& allocator, T* texels, int w, int h) : allocator(&allocator), texels(texels), w(w), h(h) {}
+
 	Image(const Image<T>&) = delete;
 	Image& operator=(const Image<T>&) = delete;
 
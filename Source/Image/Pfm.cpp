@@ -104,7 +104,11 @@ bool Pfm::SaveImage(const char* path, const Image<float3>& image)
 	writer.WriteString("%i\n", image.h);
 	writer.WriteString("-1.0\n"); // Aspect ratio and -ve indicates little endian
 
-	writer.Write(image.texels, image.w * image.h);
+	// Texel data follows the header immediately, so it must not be padded for alignment
+
+	writer.Write(image.texels, sizeof(float3) * image.w * image.h, 1);
+
+	file.Close(writer.BytesWritten());
 
 	return true;
 }
@@ -0,0 +1,50 @@
+#include <Image/Srgb.h>
+#include <Math/Scalar.h>
+
+namespace
+{
+	struct Tables
+	{
+		Tables()
+		{
+			for (int i = 0; i < 256; ++i)
+				decode[i] = GammaToLinear(i / 255.0f);
+
+			for (int i = 0; i < Srgb::encode_table_size; ++i)
+				encode[i] = uint8_t(LinearToGamma(float(i) / (Srgb::encode_table_size - 1)) * 255 + 0.5f);
+		}
+
+		// Linear value for each 8-bit code
+		//
+		float decode[256];
+
+		// 8-bit code for evenly spaced linear values
+		//
+		uint8_t encode[Srgb::encode_table_size];
+	};
+
+	const Tables& GetTables()
+	{
+		static const Tables tables;
+		return tables;
+	}
+}
+
+float Srgb::ToLinear(uint8_t code)
+{
+	return GetTables().decode[code];
+}
+
+uint8_t Srgb::FromLinear(float linear)
+{
+	// Written so that NaN maps to zero
+
+	const float clamped = linear > 0 ? (linear < 1 ? linear : 1) : 0;
+
+	return GetTables().encode[int(clamped * (encode_table_size - 1) + 0.5f)];
+}
+
+const uint8_t* Srgb::GetEncodeTable()
+{
+	return GetTables().encode;
+}
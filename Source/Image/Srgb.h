@@ -0,0 +1,23 @@
+#pragma once
+
+#include <Core/Types.h>
+
+namespace Srgb
+{
+	// Size of the encoding table. Linear values are rounded to the nearest of this many evenly
+	// spaced samples, which keeps the result within one code of exact rounding.
+	//
+	constexpr int encode_table_size = 4096;
+
+	// Convert an 8-bit sRGB code to a linear value (exact)
+	//
+	float ToLinear(uint8_t code);
+
+	// Convert a linear value to the nearest 8-bit sRGB code. Values are clamped to [0, 1].
+	//
+	uint8_t FromLinear(float linear);
+
+	// Table of encode_table_size sRGB codes for linear values in [0, 1], for vectorized lookups
+	//
+	const uint8_t* GetEncodeTable();
+}
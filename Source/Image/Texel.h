@@ -1,5 +1,6 @@
 #pragma once
 
+#include <Image/Srgb.h>
 #include <Math/Vector.h>
 #include <Core/Types.h>
 
@@ -11,16 +12,13 @@ struct Bgr
 	{
 	}
 
-	Bgr(float3 linear) :
-		b(uint8_t(LinearToGamma(linear.b) * 255)),
-		g(uint8_t(LinearToGamma(linear.g) * 255)),
-		r(uint8_t(LinearToGamma(linear.r) * 255))
+	Bgr(float3 linear) : b(Srgb::FromLinear(linear.b)), g(Srgb::FromLinear(linear.g)), r(Srgb::FromLinear(linear.r))
 	{
 	}
 
 	float3 ToLinear() const
 	{
-		return { GammaToLinear(r / 255.0f), GammaToLinear(g / 255.0f), GammaToLinear(b / 255.0f) };
+		return { Srgb::ToLinear(r), Srgb::ToLinear(g), Srgb::ToLinear(b) };
 	}
 
 	uint8_t b = 0;
@@ -36,16 +34,13 @@ struct Bgra
 	{
 	}
 
-	Bgra(float3 linear) :
-		b(uint8_t(LinearToGamma(linear.b) * 255)),
-		g(uint8_t(LinearToGamma(linear.g) * 255)),
-		r(uint8_t(LinearToGamma(linear.r) * 255))
+	Bgra(float3 linear) : b(Srgb::FromLinear(linear.b)), g(Srgb::FromLinear(linear.g)), r(Srgb::FromLinear(linear.r))
 	{
 	}
 
 	float3 ToLinear() const
 	{
-		return { GammaToLinear(r / 255.0f), GammaToLinear(g / 255.0f), GammaToLinear(b / 255.0f) };
+		return { Srgb::ToLinear(r), Srgb::ToLinear(g), Srgb::ToLinear(b) };
 	}
 
 	uint8_t b = 0;
@@ -1,26 +1,42 @@
 #include <Math/Random.h>
-#include <random>
 
 namespace
 {
-	thread_local std::mt19937 engine;
+	thread_local uint64_t state = 0;
+
+	// SplitMix64 finalizer
+	//
+	uint64_t Mix(uint64_t z)
+	{
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	uint64_t Next()
+	{
+		state += 0x9E3779B97F4A7C15ull;
+		return Mix(state);
+	}
 }
 
-void Random::SetSeed(int seed)
+void Random::SetSeed(uint64_t seed)
 {
-	engine.seed(seed);
+	// Scramble the seed so that streams started from consecutive seeds don't overlap
+
+	state = Mix(seed);
 }
 
 int Random::Integer(int min, int max)
 {
-	const std::uniform_int_distribution<int> distribution(min, max - 1);
-	return distribution(engine);
+	const uint64_t range = uint64_t(max - min);
+
+	return min + int(((Next() >> 32) * range) >> 32);
 }
 
 float Random::Real()
 {
-	const std::uniform_real_distribution<float> distribution(0, 1);
-	return distribution(engine);
+	return (Next() >> 40) * (1.0f / 16777216.0f);
 }
 
 float3 Random::PointOnSphere()
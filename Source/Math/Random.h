@@ -4,9 +4,11 @@
 
 namespace Random
 {
-	// Set the seed
+	// Set the seed for the current thread. Seeding is cheap, so a new stream can be started for
+	// every sample to make the random numbers depend only on the seed and not on how many
+	// numbers were used before.
 	//
-	void SetSeed(int seed);
+	void SetSeed(uint64_t seed);
 
 	// Int in the range [min, max)
 	//
@@ -124,12 +124,12 @@ inline float LinearToGamma(float linear)
 
 inline bool IsNan(float v)
 {
-	return isnan(v);
+	return std::isnan(v);
 }
 
 inline bool IsInf(float v)
 {
-	return isinf(v);
+	return std::isinf(v);
 }
 
 inline int Square(int x)
@@ -465,12 +465,12 @@ inline float3 Reflect(float3 v, float3 n)
 
 inline float3 Exp(float3 v)
 {
-	return { exp(v.x), exp(v.y), exp(v.z) };
+	return { expf(v.x), expf(v.y), expf(v.z) };
 }
 
 inline float3 Sqrt(float3 v)
 {
-	return { sqrt(v.x), sqrt(v.y), sqrt(v.z) };
+	return { sqrtf(v.x), sqrtf(v.y), sqrtf(v.z) };
 }
 
 inline float3 Abs(float3 v)
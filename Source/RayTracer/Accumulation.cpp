@@ -0,0 +1,205 @@
+#include <RayTracer/Accumulation.h>
+#include <System/File.h>
+#include <Core/Memory.h>
+#include <Core/Scratch.h>
+#include <Core/Writer.h>
+#include <Core/Log.h>
+#include <cstring>
+
+namespace
+{
+	// Bump the version whenever the layout changes
+	//
+	constexpr uint32_t accumulation_magic = 0x43434152; // RACC
+	constexpr uint32_t accumulation_version = 1;
+
+	struct AccumulationHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		int32_t w;
+		int32_t h;
+		int32_t first_sample;
+		int32_t last_sample;
+	};
+}
+
+AccumulationTarget::AccumulationTarget(Allocator& allocator, int w, int h, int first_sample, int last_sample) :
+	first_sample(first_sample), last_sample(last_sample)
+{
+	Reset(allocator, w, h);
+}
+
+int AccumulationTarget::GetWidth() const
+{
+	return sums.w;
+}
+
+int AccumulationTarget::GetHeight() const
+{
+	return sums.h;
+}
+
+void AccumulationTarget::BeginTile(Tile tile)
+{
+	if (display)
+		display->BeginTile(tile);
+}
+
+void AccumulationTarget::WriteTile(Tile tile, const float3* radiance)
+{
+	unused(tile);
+	unused(radiance);
+
+	CRITICAL(false, "Accumulation targets need the sample sums rather than the mean radiance");
+}
+
+void AccumulationTarget::WriteSamples(Tile tile, const SampleSum* texels)
+{
+	// Add to what's already there so that successive passes over different sample ranges can
+	// be rendered into the same target
+
+	ScopedLock lock(mutex);
+
+	for (int y = 0; y < tile.h; ++y)
+	{
+		for (int x = 0; x < tile.w; ++x)
+			sums(tile.x + x, tile.y + y).Add(texels[y * tile.w + x]);
+	}
+
+	if (!display)
+		return;
+
+	// Show the mean over all the samples so far, while still holding the lock so that an
+	// older mean never replaces a newer one
+
+	ScratchScope scratch;
+
+	float3* means = scratch.NewArray<float3>(tile.w * tile.h);
+
+	for (int y = 0; y < tile.h; ++y)
+	{
+		for (int x = 0; x < tile.w; ++x)
+			means[y * tile.w + x] = sums(tile.x + x, tile.y + y).GetMean();
+	}
+
+	display->WriteTile(tile, means);
+}
+
+void AccumulationTarget::Reset(Allocator& allocator, int w, int h)
+{
+	if (sums.w != w || sums.h != h)
+	{
+		Memory::TagScope tag(Memory::Tag::Framebuffers);
+
+		sums = Image<SampleSum>();
+		sums = Image<SampleSum>(allocator, w, h);
+	}
+
+	sums.Fill(SampleSum());
+}
+
+bool AccumulationTarget::Save(const char* path) const
+{
+	const size_t size = sizeof(AccumulationHeader) + sizeof(SampleSum) * sums.w * sums.h;
+
+	File file;
+
+	if (!file.OpenForWrite(path, size))
+	{
+		LOG_ERROR("Failed to save samples to %s", path);
+		return false;
+	}
+
+	Writer writer(file.contents, file.size);
+
+	const AccumulationHeader header = { accumulation_magic, accumulation_version, sums.w, sums.h, first_sample, last_sample };
+
+	writer.Write(&header, 1);
+	writer.Write(sums.texels, sums.w * sums.h);
+
+	file.Close(writer.BytesWritten());
+
+	return true;
+}
+
+bool AccumulationTarget::Load(Allocator& allocator, const char* path)
+{
+	File file;
+
+	if (!file.OpenForRead(path))
+		return false;
+
+	if (file.size < sizeof(AccumulationHeader))
+	{
+		LOG_ERROR("%s is too small to be an accumulation file", path);
+		return false;
+	}
+
+	AccumulationHeader header;
+	memcpy(&header, file.contents, sizeof(header));
+
+	if (header.magic != accumulation_magic || header.version != accumulation_version)
+	{
+		LOG_ERROR("%s isn't a supported accumulation file", path);
+		return false;
+	}
+
+	const size_t size = sizeof(SampleSum) * header.w * header.h;
+
+	if (header.w <= 0 || header.h <= 0 || file.size != sizeof(header) + size)
+	{
+		LOG_ERROR("%s has bad dimensions", path);
+		return false;
+	}
+
+	{
+		Memory::TagScope tag(Memory::Tag::Framebuffers);
+
+		sums = Image<SampleSum>(allocator, header.w, header.h);
+	}
+
+	memcpy(sums.texels, static_cast<const uint8_t*>(file.contents) + sizeof(header), size);
+
+	first_sample = header.first_sample;
+	last_sample = header.last_sample;
+
+	return true;
+}
+
+bool AccumulationTarget::Merge(const AccumulationTarget& other)
+{
+	if (other.sums.w != sums.w || other.sums.h != sums.h)
+	{
+		LOG_ERROR("Can't merge a %i x %i render into a %i x %i one", other.sums.w, other.sums.h, sums.w, sums.h);
+		return false;
+	}
+
+	// Ranges are only merged in order, so that the sums for a set of ranges are always added
+	// in the same order
+
+	if (other.first_sample != last_sample)
+	{
+		LOG_ERROR("Can't merge samples [%i, %i) after [%i, %i) because they aren't contiguous", other.first_sample, other.last_sample, first_sample, last_sample);
+		return false;
+	}
+
+	const int count = sums.w * sums.h;
+
+	for (int i = 0; i < count; ++i)
+		sums[i].Add(other.sums[i]);
+
+	last_sample = other.last_sample;
+
+	return true;
+}
+
+void AccumulationTarget::Resolve(FramebufferTarget& target) const
+{
+	target.Resize(sums.w, sums.h);
+
+	const int count = sums.w * sums.h;
+
+	for (int i = 0; i < count; ++i)
+		target.radiance[i] = sums[i].GetMean();
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <RayTracer/RenderTarget.h>
+
+// Collects the raw sample sums for a range of samples, so that renders of the same frame with
+// different sample ranges can be done by separate processes and merged afterwards
+//
+struct AccumulationTarget : RenderTarget
+{
+	AccumulationTarget() = default;
+	AccumulationTarget(Allocator& allocator, int w, int h, int first_sample, int last_sample);
+
+	int GetWidth() const override;
+	int GetHeight() const override;
+
+	void BeginTile(Tile tile) override;
+	void WriteTile(Tile tile, const float3* radiance) override;
+	void WriteSamples(Tile tile, const SampleSum* sums) override;
+
+	// Clear the sums, reallocating them if the dimensions have changed. Must not be called
+	// during a render
+	//
+	void Reset(Allocator& allocator, int w, int h);
+
+	// Save the sums and sample range to an accumulation file
+	//
+	bool Save(const char* path) const;
+
+	// Load an accumulation file
+	//
+	bool Load(Allocator& allocator, const char* path);
+
+	// Add the sums from another render of the same frame with a separate sample range
+	//
+	bool Merge(const AccumulationTarget& other);
+
+	// Write the mean radiance for each pixel
+	//
+	void Resolve(FramebufferTarget& target) const;
+
+	// Sums for each pixel. Tiles written to the target are added to these
+	//
+	Image<SampleSum> sums;
+
+	// Range of samples that have been accumulated, [first_sample, last_sample)
+	//
+	int first_sample = 0;
+	int last_sample = 0;
+
+	// Target to show the mean of each tile on as it's written, or null for none
+	//
+	FramebufferTarget* display = nullptr;
+
+	// Guards the sums, since refining a region can write a tile that's still being rendered
+	//
+	Mutex mutex;
+};
@@ -0,0 +1,242 @@
+#include <RayTracer/AllocatorBenchmark.h>
+#include <Math/Random.h>
+#include <System/SystemAllocator.h>
+#include <System/Thread.h>
+#include <System/Host.h>
+#include <System/Time.h>
+#include <Core/Constants.h>
+#include <Core/HeapAllocator.h>
+#include <Core/PoolAllocator.h>
+#include <Core/SharedAllocator.h>
+#include <Core/Generic.h>
+#include <Core/Array.h>
+#include <Core/Log.h>
+#include <atomic>
+
+namespace
+{
+	// Allocations made while loading assets. Most are small records and strings, with some
+	// buffers and a few images.
+	//
+	constexpr int asset_count = 20000;
+
+	// Frames rendered by each worker, with the tiles rendered in a frame and the small
+	// allocations made for the paths of a tile
+	//
+	constexpr int frame_count = 100;
+	constexpr int tiles_per_frame = 16;
+	constexpr int paths_per_tile = 64;
+
+	// Heap used as the baseline
+	//
+	constexpr size_t heap_size = 256_MiB;
+
+	// Fill the first bytes of an allocation with its size, so that overlapping allocations are
+	// caught when the sizes are checked before freeing
+	//
+	void Stamp(void* allocation, size_t size)
+	{
+		*static_cast<size_t*>(allocation) = size;
+	}
+
+	bool Check(const void* allocation, size_t size)
+	{
+		return *static_cast<const size_t*>(allocation) == size;
+	}
+
+	struct Assets
+	{
+		Assets(Allocator& allocator) :
+			sizes(allocator, asset_count), order(allocator, asset_count), allocations(allocator, asset_count)
+		{
+			Random::SetSeed(0x5eed);
+
+			for (int i = 0; i < asset_count; ++i)
+			{
+				const int kind = Random::Integer(0, 1000);
+
+				if (kind < 5)
+					sizes[i] = size_t(Random::Integer(64, 1024)) * 1_KiB;
+				else if (kind < 95)
+					sizes[i] = size_t(Random::Integer(1, 32)) * 1_KiB;
+				else
+					sizes[i] = size_t(Random::Integer(16, 1024));
+
+				order[i] = i;
+			}
+
+			// Assets are unloaded in a different order to the one they were loaded in
+
+			for (int i = asset_count - 1; i > 0; --i)
+				Swap(order[i], order[Random::Integer(0, i + 1)]);
+		}
+
+		Array<size_t> sizes;
+		Array<int> order;
+		Array<void*> allocations;
+	};
+
+	// Allocate all the assets and free them again, returning the time taken or a negative
+	// time if an allocation was overwritten
+	//
+	float RunAssets(Allocator& allocator, Assets& assets)
+	{
+		const uint64_t start = Time::Now();
+
+		for (int i = 0; i < asset_count; ++i)
+		{
+			assets.allocations[i] = allocator.Allocate(assets.sizes[i], 16);
+			Stamp(assets.allocations[i], assets.sizes[i]);
+		}
+
+		bool valid = true;
+
+		for (int i = 0; i < asset_count; ++i)
+		{
+			const int asset = assets.order[i];
+
+			valid &= Check(assets.allocations[asset], assets.sizes[asset]);
+			allocator.Deallocate(assets.allocations[asset]);
+		}
+
+		const float duration = Time::Elapsed(start, Time::Now());
+
+		return valid ? duration : -1.0f;
+	}
+
+	struct Frames
+	{
+		Allocator* allocator = nullptr;
+		std::atomic<bool> valid = { true };
+	};
+
+	// Render frames on one worker. Each tile has an accumulation buffer, and each path makes a
+	// few small allocations that live until the end of the path, or the end of the tile.
+	//
+	unsigned long THREAD_ENTRY RenderFrames(void* parameter)
+	{
+		Frames& frames = *static_cast<Frames*>(parameter);
+		Allocator& allocator = *frames.allocator;
+
+		void* paths[paths_per_tile];
+		bool valid = true;
+
+		for (int frame = 0; frame < frame_count; ++frame)
+		{
+			for (int tile = 0; tile < tiles_per_frame; ++tile)
+			{
+				const size_t tile_size = 16 * 16 * 4 * sizeof(float);
+
+				void* buffer = allocator.Allocate(tile_size, 64);
+				Stamp(buffer, tile_size);
+
+				for (int i = 0; i < paths_per_tile; ++i)
+				{
+					paths[i] = allocator.Allocate(32 + 16 * (i % 16), 16);
+					Stamp(paths[i], 32 + 16 * (i % 16));
+
+					void* vertex = allocator.Allocate(96, 16);
+					Stamp(vertex, 96);
+					valid &= Check(vertex, 96);
+					allocator.Deallocate(vertex);
+				}
+
+				for (int i = paths_per_tile - 1; i >= 0; --i)
+				{
+					valid &= Check(paths[i], 32 + 16 * (i % 16));
+					allocator.Deallocate(paths[i]);
+				}
+
+				valid &= Check(buffer, tile_size);
+				allocator.Deallocate(buffer);
+			}
+		}
+
+		if (!valid)
+			frames.valid = false;
+
+		return 0;
+	}
+
+	// Render frames on all workers, returning the time taken or a negative time if an
+	// allocation was overwritten
+	//
+	float RunFrames(Allocator& allocator, int threads)
+	{
+		Frames frames;
+		frames.allocator = &allocator;
+
+		Thread workers[max_worker_count];
+
+		const uint64_t start = Time::Now();
+
+		for (int i = 0; i < threads; ++i)
+			workers[i] = Thread(RenderFrames, &frames);
+
+		Join(workers, threads);
+
+		const float duration = Time::Elapsed(start, Time::Now());
+
+		return frames.valid ? duration : -1.0f;
+	}
+
+	// Return the fastest time of the runs, or a negative time if any run failed
+	//
+	template<typename F>
+	float Fastest(int runs, F run)
+	{
+		float fastest = max_float_value;
+
+		for (int i = 0; i < runs; ++i)
+		{
+			const float duration = run();
+
+			if (duration < 0)
+				return duration;
+
+			fastest = Min(fastest, duration);
+		}
+
+		return fastest;
+	}
+
+	void LogResult(const char* workload, float heap, float pool, int operations)
+	{
+		const double heap_ns = 1e9 * heap / operations;
+		const double pool_ns = 1e9 * pool / operations;
+
+		LOG_INFO("  %-10s heap %8.1f ns, pool %8.1f ns per allocation and free, %.2fx", workload, heap_ns, pool_ns, heap_ns / pool_ns);
+	}
+}
+
+bool AllocatorBenchmark::Run(Allocator& allocator, int threads, int runs)
+{
+	threads = Clamp(threads > 0 ? threads : Host::GetCpuCoreCount(), 1, max_worker_count);
+
+	HeapAllocator heap(allocator, heap_size);
+	SharedAllocator shared_heap(heap);
+
+	PageAllocator pages;
+	PoolAllocator pool(pages);
+
+	Assets assets(allocator);
+
+	const float heap_assets = Fastest(runs, [&]() { return RunAssets(heap, assets); });
+	const float pool_assets = Fastest(runs, [&]() { return RunAssets(pool, assets); });
+
+	const float heap_frames = Fastest(runs, [&]() { return RunFrames(shared_heap, threads); });
+	const float pool_frames = Fastest(runs, [&]() { return RunFrames(pool, threads); });
+
+	if (heap_assets < 0 || pool_assets < 0 || heap_frames < 0 || pool_frames < 0)
+	{
+		LOG_ERROR("Allocations overlapped (heap %s, pool %s)", heap_assets < 0 || heap_frames < 0 ? "failed" : "passed", pool_assets < 0 || pool_frames < 0 ? "failed" : "passed");
+		return false;
+	}
+
+	LOG_INFO("Allocator benchmark, fastest of %i runs, %i frame workers", runs, threads);
+
+	LogResult("Assets", heap_assets, pool_assets, asset_count);
+	LogResult("Frames", heap_frames, pool_frames, threads * frame_count * tiles_per_frame * (1 + 2 * paths_per_tile));
+
+	return true;
+}
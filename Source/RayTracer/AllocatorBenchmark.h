@@ -0,0 +1,16 @@
+#pragma once
+
+struct Allocator;
+
+// Compares the pool allocator against a heap on the allocation patterns of the renderer:
+// loading assets, where many allocations of mixed sizes live until the scene is unloaded, and
+// rendering frames, where every worker allocates and frees small buffers for each tile. The
+// heap is locked around each call when it's shared between workers, as it would have to be.
+//
+namespace AllocatorBenchmark
+{
+	// Run each workload on both allocators and log the time per allocation. Threads is the
+	// number of workers for the per-frame workload, or 0 for every core.
+	//
+	bool Run(Allocator& allocator, int threads, int runs);
+}
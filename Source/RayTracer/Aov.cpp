@@ -0,0 +1,255 @@
+#include <RayTracer/Aov.h>
+#include <RayTracer/Brdf/UberBrdf.h>
+#include <RayTracer/Intersection.h>
+#include <RayTracer/Material.h>
+#include <Image/Pfm.h>
+#include <Core/Generic.h>
+#include <Core/Memory.h>
+#include <Core/String.h>
+#include <Core/Log.h>
+#include <cstring>
+
+namespace
+{
+	constexpr const char* aov_names[aov_count] =
+	{
+		"albedo",
+		"normal",
+		"depth",
+		"roughness",
+		"direct",
+		"indirect",
+	};
+
+	constexpr int aov_components[aov_count] = { 3, 3, 1, 1, 3, 3 };
+}
+
+const char* GetAovName(Aov aov)
+{
+	return aov_names[int(aov)];
+}
+
+int GetAovComponentCount(Aov aov)
+{
+	return aov_components[int(aov)];
+}
+
+bool ParseAovMask(uint32_t& mask, const char* text)
+{
+	mask = 0;
+
+	if (!text)
+		return false;
+
+	while (*text)
+	{
+		const char* separator = strchr(text, ',');
+		const size_t length = separator ? size_t(separator - text) : strlen(text);
+
+		char name[32];
+
+		if (length >= sizeof(name))
+			return false;
+
+		memcpy(name, text, length);
+		name[length] = 0;
+
+		const bool all = String::CompareNoCase(name, "all") == 0;
+
+		bool found = all;
+
+		for (int i = 0; i < aov_count; ++i)
+		{
+			if (all || String::CompareNoCase(name, aov_names[i]) == 0)
+			{
+				mask |= 1u << i;
+				found = true;
+			}
+		}
+
+		if (!found)
+			return false;
+
+		text += separator ? length + 1 : length;
+	}
+
+	return mask != 0;
+}
+
+void AovSample::SetSurface(const Intersection& intersection, const UberBrdf& brdf)
+{
+	for (int c = 0; c < 3; ++c)
+		albedo.values[c] = Min(brdf.albedo.values[c] + brdf.reflectance.values[c], 1.0f);
+	normal = brdf.normal;
+	depth = intersection.t;
+
+	// The brdf's roughness has been raised by firefly reduction, so take the material's own
+
+	roughness = intersection.material->roughness->Sample(intersection.uv);
+}
+
+const float* AovSample::Get(Aov aov) const
+{
+	switch (aov)
+	{
+	case Aov::Albedo:
+		return albedo.values;
+	case Aov::Normal:
+		return normal.values;
+	case Aov::Depth:
+		return &depth;
+	case Aov::Roughness:
+		return &roughness;
+	case Aov::Direct:
+		return direct.values;
+	case Aov::Indirect:
+		return indirect.values;
+	default:
+		ASSERT(false, "Unknown AOV");
+		return nullptr;
+	}
+}
+
+AovBuffer::AovBuffer(Allocator& allocator, int w, int h, int tile_size, uint32_t mask) :
+	w(w), h(h), tile_size(tile_size), tiles_x((w + tile_size - 1) / tile_size), mask(mask)
+{
+	for (int i = 0; i < aov_count; ++i)
+	{
+		planes[i] = -1;
+
+		if (IsEnabled(Aov(i)))
+		{
+			planes[i] = plane_count;
+			plane_count += GetAovComponentCount(Aov(i));
+		}
+	}
+
+	const int tiles_y = (h + tile_size - 1) / tile_size;
+
+	Memory::TagScope tag(Memory::Tag::Aovs);
+
+	values = Array<float>(allocator, tiles_x * tiles_y * GetPlaneCount() * tile_size * tile_size);
+
+	memset(values.values, 0, sizeof(float) * values.count);
+}
+
+void AovBuffer::AddSample(float* sums, int pixel_count, int pixel, const AovSample& sample) const
+{
+	for (int i = 0; i < aov_count; ++i)
+	{
+		if (!IsEnabled(Aov(i)))
+			continue;
+
+		const float* components = sample.Get(Aov(i));
+
+		float* plane = sums + planes[i] * pixel_count + pixel;
+
+		for (int c = 0; c < GetAovComponentCount(Aov(i)); ++c)
+			plane[c * pixel_count] += components[c];
+	}
+
+	sums[plane_count * pixel_count + pixel] += 1;
+}
+
+void AovBuffer::AddTile(Tile tile, const float* sums)
+{
+	const int pixel_count = tile.w * tile.h;
+	const int plane_size = tile_size * tile_size;
+
+	// Tasks can cover part of a tile when rendering regions, but never more than one tile
+
+	const int tx = tile.x % tile_size;
+	const int ty = tile.y % tile_size;
+
+	ASSERT(tx + tile.w <= tile_size && ty + tile.h <= tile_size, "Tile doesn't match the AOV buffer");
+
+	float* block = values.values + size_t((tile.y / tile_size) * tiles_x + tile.x / tile_size) * GetPlaneCount() * plane_size;
+
+	for (int p = 0; p < GetPlaneCount(); ++p)
+	{
+		const float* source = sums + p * pixel_count;
+
+		float* plane = block + p * plane_size;
+
+		for (int y = 0; y < tile.h; ++y)
+		{
+			float* row = plane + (ty + y) * tile_size + tx;
+
+			for (int x = 0; x < tile.w; ++x)
+				row[x] += source[y * tile.w + x];
+		}
+	}
+}
+
+float AovBuffer::GetMean(int x, int y, Aov aov, int component) const
+{
+	ASSERT(IsEnabled(aov));
+
+	const int plane_size = tile_size * tile_size;
+
+	const float* block = values.values + size_t((y / tile_size) * tiles_x + x / tile_size) * GetPlaneCount() * plane_size;
+
+	const int offset = (y % tile_size) * tile_size + x % tile_size;
+
+	const float count = block[plane_count * plane_size + offset];
+
+	return count > 0 ? block[(planes[int(aov)] + component) * plane_size + offset] / count : 0.0f;
+}
+
+void AovBuffer::Resolve(Image<float3>& image, Aov aov) const
+{
+	ASSERT(image.w == w && image.h == h);
+
+	const int components = GetAovComponentCount(aov);
+
+	for (int y = 0; y < h; ++y)
+	{
+		for (int x = 0; x < w; ++x)
+		{
+			float3& texel = image(x, y);
+
+			for (int c = 0; c < 3; ++c)
+				texel.values[c] = GetMean(x, y, aov, components == 3 ? c : 0);
+		}
+	}
+}
+
+bool AovBuffer::Save(const char* path, float exposure) const
+{
+	// Insert the AOV name before the extension
+
+	const char* extension = strrchr(path, '.');
+
+	const int stem = extension ? int(extension - path) : int(strlen(path));
+
+	Image<float3> image(Memory::TempAllocator(), w, h);
+
+	bool success = true;
+
+	for (int i = 0; i < aov_count; ++i)
+	{
+		const Aov aov = Aov(i);
+
+		if (!IsEnabled(aov))
+			continue;
+
+		Resolve(image, aov);
+
+		if (aov == Aov::Direct || aov == Aov::Indirect)
+		{
+			for (int p = 0; p < w * h; ++p)
+				image[p] = image[p] * exposure;
+		}
+
+		char aov_path[1024];
+
+		String::Format(aov_path, sizeof(aov_path), "%.*s.%s.pfm", stem, path, GetAovName(aov));
+
+		if (Pfm::SaveImage(aov_path, image))
+			LOG_INFO("Saved the %s AOV to %s", GetAovName(aov), aov_path);
+		else
+			success = false;
+	}
+
+	return success;
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <RayTracer/Tile.h>
+#include <Image/Image.h>
+#include <Math/Vector.h>
+#include <Core/Array.h>
+#include <Core/Types.h>
+
+struct Intersection;
+struct UberBrdf;
+
+// Arbitrary output variables, extra channels written by the integrator in the same pass as
+// the radiance, for denoising and compositing
+//
+enum class Aov : uint8_t
+{
+	Albedo,
+	Normal,
+	Depth,
+	Roughness,
+	Direct,
+	Indirect,
+	Count
+};
+
+constexpr int aov_count = int(Aov::Count);
+
+// Return the name of the AOV, as used on the command line and in file names
+//
+const char* GetAovName(Aov aov);
+
+// Return the number of float components of the AOV
+//
+int GetAovComponentCount(Aov aov);
+
+// Parse a comma separated list of AOV names, or "all", into a mask with a bit for each
+//
+bool ParseAovMask(uint32_t& mask, const char* text);
+
+// Values of every AOV for a single sample. The surface values are taken where the camera ray
+// first hits and are left as zero where it escapes.
+//
+struct AovSample
+{
+	// Fill in the surface AOVs from the first hit
+	//
+	void SetSurface(const Intersection& intersection, const UberBrdf& brdf);
+
+	// Return the components of the AOV
+	//
+	const float* Get(Aov aov) const;
+
+	// Diffuse albedo plus specular reflectance
+	//
+	float3 albedo = { 0, 0, 0 };
+
+	// World-space shading normal
+	//
+	float3 normal = { 0, 0, 0 };
+
+	// Distance along the camera ray (m)
+	//
+	float depth = 0;
+
+	// Material roughness
+	//
+	float roughness = 0;
+
+	// Radiance from the environment seen directly and from the lights at the first hit, and
+	// the radiance from every later bounce
+	//
+	float3 direct = { 0, 0, 0 };
+	float3 indirect = { 0, 0, 0 };
+};
+
+// Multi-channel float framebuffer for a set of AOVs. Each tile is stored as one plane of
+// tile_size x tile_size values for every component of the enabled AOVs, followed by a plane of
+// sample counts, so that the values of one channel of a tile are contiguous. Sums are kept
+// rather than means, so that renders made of several sample ranges add up.
+//
+struct AovBuffer
+{
+	AovBuffer() = default;
+	AovBuffer(Allocator& allocator, int w, int h, int tile_size, uint32_t mask);
+
+	// Return true if the AOV is enabled
+	//
+	bool IsEnabled(Aov aov) const
+	{
+		return (mask & (1u << int(aov))) != 0;
+	}
+
+	// Return the number of floats of sums to keep for each pixel of a tile being rendered
+	//
+	int GetPlaneCount() const
+	{
+		return plane_count + 1;
+	}
+
+	// Add a sample to the sums for a tile being rendered, stored as GetPlaneCount() planes of
+	// pixel_count values
+	//
+	void AddSample(float* sums, int pixel_count, int pixel, const AovSample& sample) const;
+
+	// Add the sums for a completed tile to the buffer
+	//
+	void AddTile(Tile tile, const float* sums);
+
+	// Return the mean of a component of an AOV at a pixel
+	//
+	float GetMean(int x, int y, Aov aov, int component) const;
+
+	// Copy the mean of an AOV at every pixel into the image, replicating scalar AOVs
+	//
+	void Resolve(Image<float3>& image, Aov aov) const;
+
+	// Save each enabled AOV as .pfm next to the path, e.g. as Render.albedo.pfm for
+	// Render.pfm. The radiance AOVs are exposed like the render.
+	//
+	bool Save(const char* path, float exposure) const;
+
+	// Dimensions in pixels, and of the tiles the values are grouped by
+	//
+	int w = 0;
+	int h = 0;
+	int tile_size = 0;
+	int tiles_x = 0;
+
+	// Enabled AOVs, as a bit for each
+	//
+	uint32_t mask = 0;
+
+	// First plane of each enabled AOV, and the number of planes of values
+	//
+	int planes[aov_count] = {};
+	int plane_count = 0;
+
+	// Planes of every tile
+	//
+	Array<float> values;
+};
@@ -0,0 +1,333 @@
+#include <RayTracer/Benchmark.h>
+#include <RayTracer/Integrator/PathIntegrator.h>
+#include <RayTracer/Texture/ConstantTexture.h>
+#include <RayTracer/RenderTarget.h>
+#include <RayTracer/Renderer.h>
+#include <RayTracer/Material.h>
+#include <RayTracer/Camera.h>
+#include <RayTracer/Scene.h>
+#include <RayTracer/Stats.h>
+#include <Math/Random.h>
+#include <System/File.h>
+#include <System/Time.h>
+#include <Core/Allocator.h>
+#include <Core/Memory.h>
+#include <Core/Array.h>
+#include <Core/Writer.h>
+#include <Core/String.h>
+#include <Core/Log.h>
+#include <algorithm>
+
+#define BENCHMARK_STRING(x) #x
+#define BENCHMARK_VERSION(x) BENCHMARK_STRING(x)
+
+#if defined(DEBUG_BUILD)
+	#define BENCHMARK_CONFIGURATION "Debug"
+#elif defined(RELEASE_BUILD)
+	#define BENCHMARK_CONFIGURATION "Release"
+#elif defined(FINAL_BUILD)
+	#define BENCHMARK_CONFIGURATION "Final"
+#else
+	#define BENCHMARK_CONFIGURATION "Unknown"
+#endif
+
+#if defined(__clang__)
+	#define BENCHMARK_COMPILER "Clang " __clang_version__
+#elif defined(__GNUC__)
+	#define BENCHMARK_COMPILER "GCC " __VERSION__
+#elif defined(_MSC_VER)
+	#define BENCHMARK_COMPILER "MSVC " BENCHMARK_VERSION(_MSC_FULL_VER)
+#else
+	#define BENCHMARK_COMPILER "unknown compiler"
+#endif
+
+namespace
+{
+	// Configuration and compiler, so that results from different toolchains aren't mistaken
+	// for a regression
+	//
+	const char* build = BENCHMARK_CONFIGURATION " (" BENCHMARK_COMPILER ")";
+
+	// Untextured materials for the sphere field
+	//
+	ConstantTexture<float3> flat_normal = { { 0.5f, 0.5f, 1.0f } };
+	ConstantTexture<float3> red = { { 0.6f, 0.1f, 0.1f } };
+	ConstantTexture<float3> green = { { 0.1f, 0.6f, 0.1f } };
+	ConstantTexture<float3> grey = { { 0.5f, 0.5f, 0.5f } };
+	ConstantTexture<float> rough = { 0.6f };
+	ConstantTexture<float> smooth = { 0.2f };
+	ConstantTexture<float> zero = { 0.0f };
+	ConstantTexture<float> one = { 1.0f };
+
+	const Material field_materials[] =
+	{
+		Material(flat_normal, red, rough, zero),
+		Material(flat_normal, green, smooth, zero),
+		Material(flat_normal, grey, smooth, one),
+	};
+
+	const Material ground_material(flat_normal, grey, rough, zero);
+
+	struct Canonical
+	{
+		// Name used in the results and to pick the scene
+		//
+		const char* name;
+
+		// Fixed render settings
+		//
+		int w;
+		int h;
+		int quality;
+		int max_depth;
+
+		// Fill in the scene and return the camera
+		//
+		Camera(*build)(Scene& scene, const Material* materials, int material_count);
+	};
+
+	// The viewer's scene: a ground plane and three spheres
+	//
+	Camera BuildDefault(Scene& scene, const Material* materials, int material_count)
+	{
+		scene.planes.push_back({ { 0, 0, 0 }, { 0, 1, 0 }, materials[0] });
+
+		scene.spheres.push_back({ { +0.00f, 0.1f, 0.0f }, 0.1f, materials[1 % material_count] });
+		scene.spheres.push_back({ { +0.3f, 0.1f, 0.3f }, 0.1f, materials[2 % material_count] });
+		scene.spheres.push_back({ { -0.3f, 0.1f, 0.3f }, 0.1f, materials[3 % material_count] });
+
+		return Camera({ 0.09f, 0.05f, -0.4f }, { 0, 0.1f, -0.1f });
+	}
+
+	// 100k small spheres scattered over a plane, which stresses intersection
+	//
+	Camera BuildSphereField(Scene& scene, const Material* materials, int material_count)
+	{
+		unused(materials);
+		unused(material_count);
+
+		scene.planes.push_back({ { 0, 0, 0 }, { 0, 1, 0 }, ground_material });
+
+		// Use a fixed seed so that the field is the same for every build
+
+		Random::SetSeed(0x5eed);
+
+		scene.spheres.reserve(100000);
+
+		for (int i = 0; i < 100000; ++i)
+		{
+			const float radius = 0.002f + 0.008f * Random::Real();
+			const float3 center = { Random::Real() * 4 - 2, radius, Random::Real() * 4 - 1 };
+
+			scene.spheres.push_back({ center, radius, field_materials[Random::Integer(0, countof(field_materials))] });
+		}
+
+		return Camera({ 0, 0.4f, -1.2f }, { 0, 0, 0.3f });
+	}
+
+	// Close up grid of textured spheres that fills the frame, which stresses texture lookups
+	//
+	Camera BuildTextures(Scene& scene, const Material* materials, int material_count)
+	{
+		scene.planes.push_back({ { 0, 0, 0 }, { 0, 1, 0 }, materials[0] });
+
+		for (int z = 0; z < 8; ++z)
+		{
+			for (int x = 0; x < 16; ++x)
+			{
+				const float3 center = { (x - 7.5f) * 0.05f, 0.02f, z * 0.05f };
+
+				scene.spheres.push_back({ center, 0.02f, materials[(x + z) % material_count] });
+			}
+		}
+
+		return Camera({ 0, 0.12f, -0.25f }, { 0, 0, 0.1f });
+	}
+
+	// Nothing but the sky, which stresses the atmosphere
+	//
+	Camera BuildSky(Scene& scene, const Material* materials, int material_count)
+	{
+		unused(materials);
+		unused(material_count);
+		unused(scene);
+
+		return Camera({ 0, 1, 0 }, { 0, 1.3f, 1 });
+	}
+
+	const Canonical scenes[] =
+	{
+		{ "default", 512, 256, 4, 6, BuildDefault },
+		{ "spheres", 64, 32, 1, 2, BuildSphereField },
+		{ "textures", 384, 192, 4, 4, BuildTextures },
+		{ "sky", 512, 256, 4, 2, BuildSky },
+	};
+
+	struct Result
+	{
+		const Canonical* scene = nullptr;
+
+		// Wall clock time of the timed runs in seconds
+		//
+		float median = 0;
+		float min = 0;
+		float max = 0;
+
+		// Rays cast by each run
+		//
+		uint64_t rays = 0;
+
+		// Most memory the allocators held at once during the scene, summed over the peaks of
+		// each tag. The scene geometry is in standard containers, which aren't tracked.
+		//
+		size_t peak_memory = 0;
+	};
+
+	Result RunScene(Allocator& allocator, const Benchmark::Settings& settings, const Canonical& canonical, const Material* materials, int material_count)
+	{
+		// Start the peaks from what's allocated now so that earlier scenes don't count
+
+		Memory::ResetTaggedPeaks();
+
+		Scene scene;
+
+		scene.lights.push_back(scene.atmosphere.sun);
+
+		const Camera camera = canonical.build(scene, materials, material_count);
+
+		PathIntegrator integrator(canonical.max_depth);
+
+		Renderer renderer(canonical.quality, settings.threads);
+
+		FramebufferTarget target(allocator, canonical.w, canonical.h);
+
+		Array<float> durations(allocator, settings.runs);
+
+		Result result;
+
+		result.scene = &canonical;
+
+		for (int i = 0; i < settings.warmup + settings.runs; ++i)
+		{
+			const uint64_t start = Time::Now();
+
+			renderer.Render(target, camera, scene, integrator);
+
+			const float duration = Time::Elapsed(start, Time::Now());
+
+			if (i < settings.warmup)
+				continue;
+
+			durations[i - settings.warmup] = duration;
+
+			result.rays = Stats::TotalRays;
+		}
+
+		std::sort(durations.values, durations.values + durations.count);
+
+		const int n = durations.count;
+
+		result.median = n % 2 ? durations[n / 2] : 0.5f * (durations[n / 2 - 1] + durations[n / 2]);
+		result.min = durations[0];
+		result.max = durations[n - 1];
+
+		for (int i = 0; i < int(Memory::Tag::Count); ++i)
+			result.peak_memory += Memory::GetTaggedPeak(Memory::Tag(i));
+
+		LOG_INFO("Benchmark %s: median = %.3f s, min = %.3f s, max = %.3f s, %.2f Mray/s", canonical.name, result.median, result.min, result.max, result.rays * 0.000001 / result.median);
+
+		return result;
+	}
+
+	bool Save(const char* path, const Benchmark::Settings& settings, int threads, const Result* results, int count)
+	{
+		File file;
+
+		if (!file.OpenForWrite(path, 4_KiB + 1_KiB * size_t(count)))
+		{
+			LOG_ERROR("Failed to save benchmark results to %s", path);
+			return false;
+		}
+
+		Writer writer(file.contents, file.size);
+
+		writer.WriteString("{\n");
+		writer.WriteString("\t\"build\": \"%s\",\n", build);
+		writer.WriteString("\t\"threads\": %i,\n", threads);
+		writer.WriteString("\t\"warmup\": %i,\n", settings.warmup);
+		writer.WriteString("\t\"runs\": %i,\n", settings.runs);
+		writer.WriteString("\t\"scenes\": [\n");
+
+		for (int i = 0; i < count; ++i)
+		{
+			const Result& result = results[i];
+			const Canonical& scene = *result.scene;
+
+			const double samples = double(scene.w) * scene.h * scene.quality * scene.quality;
+
+			writer.WriteString("\t\t{\n");
+			writer.WriteString("\t\t\t\"name\": \"%s\",\n", scene.name);
+			writer.WriteString("\t\t\t\"width\": %i,\n", scene.w);
+			writer.WriteString("\t\t\t\"height\": %i,\n", scene.h);
+			writer.WriteString("\t\t\t\"quality\": %i,\n", scene.quality);
+			writer.WriteString("\t\t\t\"depth\": %i,\n", scene.max_depth);
+			writer.WriteString("\t\t\t\"median_seconds\": %.6f,\n", result.median);
+			writer.WriteString("\t\t\t\"min_seconds\": %.6f,\n", result.min);
+			writer.WriteString("\t\t\t\"max_seconds\": %.6f,\n", result.max);
+			writer.WriteString("\t\t\t\"rays\": %llu,\n", result.rays);
+			writer.WriteString("\t\t\t\"mrays_per_second\": %.4f,\n", result.rays * 0.000001 / result.median);
+			writer.WriteString("\t\t\t\"samples_per_second\": %.1f,\n", samples / result.median);
+			writer.WriteString("\t\t\t\"peak_memory_bytes\": %llu\n", uint64_t(result.peak_memory));
+			writer.WriteString("\t\t}%s\n", i + 1 < count ? "," : "");
+		}
+
+		writer.WriteString("\t]\n");
+		writer.WriteString("}\n");
+
+		file.Close(writer.BytesWritten());
+
+		LOG_INFO("Saved benchmark results to %s", path);
+
+		return true;
+	}
+}
+
+CommandLine::Match Benchmark::ParseOption(Settings& settings, const char* option, const char* value)
+{
+	if (CommandLine::Is(option, "-benchmark"))
+		return CommandLine::Text(settings.path, value);
+	if (CommandLine::Is(option, "-scene"))
+		return CommandLine::Text(settings.scene, value);
+	if (CommandLine::Is(option, "-runs"))
+		return CommandLine::Parsed(CommandLine::ParseInt(settings.runs, value, 1, 1000));
+	if (CommandLine::Is(option, "-warmup"))
+		return CommandLine::Parsed(CommandLine::ParseInt(settings.warmup, value, 0, 1000));
+
+	return CommandLine::Match::None;
+}
+
+bool Benchmark::Run(Allocator& allocator, const Settings& settings, const Material* materials, int material_count)
+{
+	ASSERT(material_count > 0);
+	ASSERT(settings.runs > 0);
+
+	Result results[countof(scenes)];
+
+	int count = 0;
+
+	for (const Canonical& scene : scenes)
+	{
+		if (settings.scene && String::CompareNoCase(settings.scene, scene.name) != 0)
+			continue;
+
+		results[count++] = RunScene(allocator, settings, scene, materials, material_count);
+	}
+
+	if (count == 0)
+	{
+		LOG_ERROR("There's no benchmark scene called '%s'", settings.scene);
+		return false;
+	}
+
+	return Save(settings.path, settings, Stats::WorkerCount, results, count);
+}
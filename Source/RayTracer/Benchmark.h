@@ -0,0 +1,46 @@
+#pragma once
+
+#include <RayTracer/CommandLine.h>
+
+struct Allocator;
+struct Material;
+
+// Renders a fixed set of canonical scenes with fixed settings and saves the timings as JSON,
+// so that builds can be compared against each other. Renders are deterministic for a given
+// quality, so every run of a scene does the same work.
+//
+namespace Benchmark
+{
+	struct Settings
+	{
+		// Output path for the results (.json), or null to render normally
+		//
+		const char* path = nullptr;
+
+		// Worker threads, or 0 for every core
+		//
+		int threads = 0;
+
+		// Untimed renders of each scene before the timed ones
+		//
+		int warmup = 1;
+
+		// Timed renders of each scene
+		//
+		int runs = 5;
+
+		// Name of the only scene to run, or null to run them all
+		//
+		const char* scene = nullptr;
+	};
+
+	// Parse the -benchmark, -scene, -runs and -warmup options
+	//
+	CommandLine::Match ParseOption(Settings& settings, const char* option, const char* value);
+
+	// Run the scenes and save the results to the settings' path. The textured scenes use the
+	// materials given, which are loaded from files by the caller, with the ground material
+	// first.
+	//
+	bool Run(Allocator& allocator, const Settings& settings, const Material* materials, int material_count);
+}
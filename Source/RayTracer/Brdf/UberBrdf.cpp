@@ -2,10 +2,13 @@
 #include <RayTracer/Brdf/Microfacet.h>
 #include <RayTracer/Brdf/Lambert.h>
 #include <RayTracer/Brdf/FireflyReduction.h>
+#include <RayTracer/Profiler.h>
 #include <Math/Random.h>
 
 float3 UberBrdf::Evaluate(float3 l, float3 v) const
 {
+	PROFILE_SCOPE(Brdf);
+
 	// This is a combination of a microfacet specular layer with a Lambert diffuse layer
 	// at the bottom. For energy-conservation purposes, only the light that the specular
 	// layer transmits can be used for layers below.
@@ -29,6 +32,8 @@ float3 UberBrdf::Evaluate(float3 l, float3 v) const
 
 float3 UberBrdf::Sample(float3& l, float3 v, float2 sample) const
 {
+	PROFILE_SCOPE(Brdf);
+
 	// This is a combination of a microfacet specular layer with a Lambert diffuse layer
 	// at the bottom. For energy-conservation purposes, only the light that the specular
 	// layer transmits can be used for layers below.
@@ -0,0 +1,318 @@
+#include <RayTracer/Checkpoint.h>
+#include <System/File.h>
+#include <System/Time.h>
+#include <Core/Constants.h>
+#include <Core/Memory.h>
+#include <Core/Scratch.h>
+#include <Core/Writer.h>
+#include <Core/String.h>
+#include <Core/Log.h>
+#include <cstring>
+
+namespace
+{
+	// Bump the version whenever the layout changes
+	//
+	constexpr uint32_t checkpoint_magic = 0x4b435052; // RPCK
+	constexpr uint32_t checkpoint_version = 1;
+
+	// The header is followed by a completion flag for each tile, then the sums for each
+	// completed tile in tile order, stored contiguously as tile.w x tile.h values
+	//
+	struct CheckpointHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		int32_t w;
+		int32_t h;
+		int32_t tile_size;
+		int32_t quality;
+		int32_t first_sample;
+		int32_t last_sample;
+	};
+
+	unsigned long THREAD_ENTRY WriterMain(void* parameter)
+	{
+		CheckpointTarget& checkpoint = *static_cast<CheckpointTarget*>(parameter);
+
+		uint64_t last = Time::Now();
+
+		while (!checkpoint.stopping)
+		{
+			Thread::Sleep(100);
+
+			if (Time::Elapsed(last, Time::Now()) < checkpoint.interval)
+				continue;
+
+			checkpoint.Save();
+
+			last = Time::Now();
+		}
+
+		return 0;
+	}
+
+	Tile GetTile(int tx, int ty, int tile_size, int w, int h)
+	{
+		return Tile(tx * tile_size, ty * tile_size, tile_size, tile_size).Clip(w, h);
+	}
+}
+
+CheckpointTarget::CheckpointTarget(Allocator& allocator, RenderTarget& target, const Setup& setup, const char* path) :
+	target(target),
+	setup(setup),
+	path(path),
+	tiles_w((target.GetWidth() + setup.tile_size - 1) / setup.tile_size),
+	tiles_h((target.GetHeight() + setup.tile_size - 1) / setup.tile_size)
+{
+	Memory::TagScope tag(Memory::Tag::Framebuffers);
+
+	sums = Image<SampleSum>(allocator, target.GetWidth(), target.GetHeight());
+	complete = Array<std::atomic<bool>>(allocator, tiles_w * tiles_h);
+	snapshot = Array<uint8_t>(allocator, tiles_w * tiles_h);
+
+	for (int i = 0; i < complete.count; ++i)
+		complete[i] = false;
+}
+
+CheckpointTarget::~CheckpointTarget()
+{
+	Stop();
+}
+
+int CheckpointTarget::GetWidth() const
+{
+	return sums.w;
+}
+
+int CheckpointTarget::GetHeight() const
+{
+	return sums.h;
+}
+
+void CheckpointTarget::BeginTile(Tile tile)
+{
+	target.BeginTile(tile);
+}
+
+void CheckpointTarget::WriteTile(Tile tile, const float3* radiance)
+{
+	unused(tile);
+	unused(radiance);
+
+	CRITICAL(false, "Checkpoints need the sample sums rather than the mean radiance");
+}
+
+void CheckpointTarget::WriteSamples(Tile tile, const SampleSum* texels)
+{
+	for (int y = 0; y < tile.h; ++y)
+		memcpy(&sums(tile.x, tile.y + y), texels + y * tile.w, sizeof(SampleSum) * tile.w);
+
+	// Publish the tile to the writer only once its sums are in place
+
+	complete[(tile.y / setup.tile_size) * tiles_w + tile.x / setup.tile_size].store(true, std::memory_order_release);
+
+	++completed;
+
+	target.WriteSamples(tile, texels);
+}
+
+bool CheckpointTarget::IsTileComplete(Tile tile) const
+{
+	return complete[(tile.y / setup.tile_size) * tiles_w + tile.x / setup.tile_size].load(std::memory_order_acquire);
+}
+
+bool CheckpointTarget::Resume()
+{
+	if (!File::Exists(path))
+	{
+		LOG_INFO("There is no checkpoint at %s, starting from the beginning", path);
+		return true;
+	}
+
+	File file;
+
+	if (!file.OpenForRead(path))
+		return false;
+
+	CheckpointHeader header;
+
+	const size_t flags_size = sizeof(uint8_t) * complete.count;
+
+	if (file.size < sizeof(header) + flags_size)
+	{
+		LOG_ERROR("%s is too small to be a checkpoint", path);
+		return false;
+	}
+
+	memcpy(&header, file.contents, sizeof(header));
+
+	if (header.magic != checkpoint_magic || header.version != checkpoint_version)
+	{
+		LOG_ERROR("%s isn't a supported checkpoint", path);
+		return false;
+	}
+
+	if (header.w != sums.w || header.h != sums.h || header.tile_size != setup.tile_size || header.quality != setup.quality ||
+		header.first_sample != setup.first_sample || header.last_sample != setup.last_sample)
+	{
+		LOG_ERROR("%s was saved with different render settings", path);
+		return false;
+	}
+
+	const uint8_t* flags = static_cast<const uint8_t*>(file.contents) + sizeof(header);
+	const uint8_t* head = flags + flags_size;
+	const uint8_t* end = static_cast<const uint8_t*>(file.contents) + file.size;
+
+	int resumed = 0;
+
+	for (int ty = 0; ty < tiles_h; ++ty)
+	{
+		for (int tx = 0; tx < tiles_w; ++tx)
+		{
+			if (!flags[ty * tiles_w + tx])
+				continue;
+
+			const Tile tile = GetTile(tx, ty, setup.tile_size, sums.w, sums.h);
+
+			const size_t size = sizeof(SampleSum) * tile.w * tile.h;
+
+			if (size_t(end - head) < size)
+			{
+				LOG_ERROR("%s is truncated", path);
+				return false;
+			}
+
+			// The file data isn't aligned, so copy it into the sums before passing it on
+
+			ScratchScope scratch;
+
+			SampleSum* texels = scratch.NewArray<SampleSum>(tile.w * tile.h);
+
+			memcpy(texels, head, size);
+
+			head += size;
+
+			WriteSamples(tile, texels);
+
+			++resumed;
+		}
+	}
+
+	saved = completed;
+
+	LOG_INFO("Resumed %i of %i tiles from %s", resumed, complete.count, path);
+
+	return true;
+}
+
+void CheckpointTarget::Start(float interval_)
+{
+	ASSERT(!thread.handle, "The checkpoint writer is already running");
+
+	interval = interval_;
+	stopping = false;
+	start = Time::Now();
+
+	thread = Thread(WriterMain, this);
+}
+
+void CheckpointTarget::Stop()
+{
+	if (!thread.handle)
+		return;
+
+	stopping = true;
+
+	thread.Join();
+	thread = Thread();
+
+	if (completed != saved)
+		Save();
+
+	const float duration = Time::Elapsed(start, Time::Now());
+
+	LOG_INFO("Checkpoints: count = %i, time = %.1f ms, overhead = %.2f %% of %.1f s", checkpoint_count, checkpoint_time * 1000, 100 * checkpoint_time / duration, duration);
+}
+
+bool CheckpointTarget::Save()
+{
+	const uint64_t begin = Time::Now();
+
+	// Take a copy of the flags first, since more tiles may finish while saving
+
+	uint8_t* flags = snapshot.values;
+
+	size_t size = sizeof(CheckpointHeader) + complete.count;
+
+	int count = 0;
+
+	for (int ty = 0; ty < tiles_h; ++ty)
+	{
+		for (int tx = 0; tx < tiles_w; ++tx)
+		{
+			const int i = ty * tiles_w + tx;
+
+			flags[i] = complete[i].load(std::memory_order_acquire) ? 1 : 0;
+
+			if (flags[i])
+			{
+				const Tile tile = GetTile(tx, ty, setup.tile_size, sums.w, sums.h);
+
+				size += sizeof(SampleSum) * tile.w * tile.h;
+
+				++count;
+			}
+		}
+	}
+
+	// Write to a temporary file and then swap it in, so that being killed part way through
+	// leaves the previous checkpoint intact
+
+	char temporary[max_path_length];
+
+	String::Format(temporary, sizeof(temporary), "%s.tmp", path);
+
+	{
+		File file;
+
+		if (!file.OpenForWrite(temporary, size))
+		{
+			LOG_ERROR("Failed to save a checkpoint to %s", temporary);
+			return false;
+		}
+
+		Writer writer(file.contents, file.size);
+
+		const CheckpointHeader header = { checkpoint_magic, checkpoint_version, sums.w, sums.h, setup.tile_size, setup.quality, setup.first_sample, setup.last_sample };
+
+		writer.Write(&header, 1);
+		writer.Write(flags, complete.count, 1);
+
+		for (int ty = 0; ty < tiles_h; ++ty)
+		{
+			for (int tx = 0; tx < tiles_w; ++tx)
+			{
+				if (!flags[ty * tiles_w + tx])
+					continue;
+
+				const Tile tile = GetTile(tx, ty, setup.tile_size, sums.w, sums.h);
+
+				for (int y = 0; y < tile.h; ++y)
+					writer.Write(&sums(tile.x, tile.y + y), sizeof(SampleSum) * tile.w, 1);
+			}
+		}
+
+		file.Close(writer.BytesWritten());
+	}
+
+	if (!File::Replace(temporary, path))
+		return false;
+
+	saved = count;
+
+	++checkpoint_count;
+	checkpoint_time += Time::Elapsed(begin, Time::Now());
+
+	return true;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <RayTracer/RenderTarget.h>
+#include <System/Thread.h>
+#include <Core/Array.h>
+#include <atomic>
+
+// Passes tiles through to another target while keeping the sample sums for every finished
+// tile, and saves them to disk from a background thread so that a render that is killed part
+// way through can be resumed without redoing finished tiles
+//
+struct CheckpointTarget : RenderTarget
+{
+	// Settings that a checkpoint must match to be resumed
+	//
+	struct Setup
+	{
+		// Tile size in pixels
+		//
+		int tile_size = 16;
+
+		// Render quality
+		//
+		int quality = 1;
+
+		// Range of samples rendered for each pixel
+		//
+		int first_sample = 0;
+		int last_sample = 0;
+	};
+
+	CheckpointTarget(Allocator& allocator, RenderTarget& target, const Setup& setup, const char* path);
+	~CheckpointTarget();
+
+	CheckpointTarget(const CheckpointTarget&) = delete;
+	void operator=(const CheckpointTarget&) = delete;
+
+	int GetWidth() const override;
+	int GetHeight() const override;
+
+	void BeginTile(Tile tile) override;
+	void WriteTile(Tile tile, const float3* radiance) override;
+	void WriteSamples(Tile tile, const SampleSum* sums) override;
+	bool IsTileComplete(Tile tile) const override;
+
+	// Load the finished tiles from the checkpoint and pass them on to the target. Starts from
+	// the beginning if there is no checkpoint, and fails if it doesn't match the render.
+	//
+	bool Resume();
+
+	// Save a checkpoint every interval (in seconds) on a background thread
+	//
+	void Start(float interval);
+
+	// Stop the background thread, save any tiles finished since the last checkpoint and log
+	// the overhead
+	//
+	void Stop();
+
+	// Write the finished tiles to the checkpoint file
+	//
+	bool Save();
+
+	// Target receiving the tiles
+	//
+	RenderTarget& target;
+
+	// Render settings
+	//
+	Setup setup;
+
+	// Checkpoint file
+	//
+	const char* path = nullptr;
+
+	// Number of tiles in each direction
+	//
+	int tiles_w = 0;
+	int tiles_h = 0;
+
+	// Sample sums for each pixel. Tiles are only read by the writer once they are complete,
+	// and are never written again after that.
+	//
+	Image<SampleSum> sums;
+
+	// Completion flag for each tile
+	//
+	Array<std::atomic<bool>> complete;
+
+	// Copy of the flags taken by the writer
+	//
+	Array<uint8_t> snapshot;
+
+	// Number of tiles finished, and finished as of the last checkpoint
+	//
+	std::atomic<int> completed = { 0 };
+	int saved = 0;
+
+	// Background writer
+	//
+	Thread thread;
+	std::atomic<bool> stopping = { false };
+	float interval = 0;
+
+	// Overhead stats
+	//
+	uint64_t start = 0;
+	int checkpoint_count = 0;
+	float checkpoint_time = 0;
+};
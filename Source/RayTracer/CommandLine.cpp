@@ -0,0 +1,125 @@
+#include <RayTracer/CommandLine.h>
+#include <RayTracer/Tile.h>
+#include <Core/String.h>
+#include <cstdlib>
+#include <cstring>
+
+bool CommandLine::Is(const char* option, const char* name)
+{
+	return String::CompareNoCase(option, name) == 0;
+}
+
+CommandLine::Match CommandLine::Flag(bool& result, bool value)
+{
+	result = value;
+
+	return Match::Flag;
+}
+
+CommandLine::Match CommandLine::Parsed(bool valid)
+{
+	return valid ? Match::Value : Match::Invalid;
+}
+
+CommandLine::Match CommandLine::Text(const char*& result, const char* text)
+{
+	if (!text)
+		return Match::Invalid;
+
+	result = text;
+
+	return Match::Value;
+}
+
+bool CommandLine::ParseInt(int& value, const char* text, int min, int max)
+{
+	if (!text)
+		return false;
+
+	char* end = nullptr;
+
+	const long parsed = strtol(text, &end, 10);
+
+	if (end == text || *end != 0 || parsed < min || parsed > max)
+		return false;
+
+	value = int(parsed);
+
+	return true;
+}
+
+bool CommandLine::ParseFloat(float& value, const char* text, float min, float max)
+{
+	if (!text)
+		return false;
+
+	char* end = nullptr;
+
+	const double parsed = strtod(text, &end);
+
+	if (end == text || *end != 0 || !(parsed >= min && parsed <= max))
+		return false;
+
+	value = float(parsed);
+
+	return true;
+}
+
+bool CommandLine::ParseRegion(Tile& region, const char* text)
+{
+	if (!text)
+		return false;
+
+	int values[4];
+
+	for (int i = 0; i < 4; ++i)
+	{
+		char* end = nullptr;
+
+		const long parsed = strtol(text, &end, 10);
+
+		if (end == text || parsed < 0 || parsed > 32768 || *end != (i < 3 ? ',' : 0))
+			return false;
+
+		values[i] = int(parsed);
+		text = end + 1;
+	}
+
+	region = Tile(values[0], values[1], values[2], values[3]);
+
+	return !region.IsEmpty();
+}
+
+bool CommandLine::ParseRange(int& first, int& last, const char* text)
+{
+	if (!text)
+		return false;
+
+	char buffer[32];
+
+	const char* separator = strchr(text, ':');
+
+	if (!separator || size_t(separator - text) >= sizeof(buffer))
+		return false;
+
+	memcpy(buffer, text, separator - text);
+	buffer[separator - text] = 0;
+
+	return ParseInt(first, buffer, 0, 65536) && ParseInt(last, separator + 1, first + 1, 65536);
+}
+
+bool CommandLine::ParseAddress(char* host, size_t size, int& port, const char* text)
+{
+	if (!text)
+		return false;
+
+	const char* separator = strrchr(text, ':');
+
+	if (!separator || size_t(separator - text) >= size || !ParseInt(port, separator + 1, 1, 65535))
+		return false;
+
+	memcpy(host, text, separator - text);
+	host[separator - text] = 0;
+
+	return true;
+}
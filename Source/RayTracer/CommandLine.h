@@ -0,0 +1,66 @@
+#pragma once
+
+#include <Core/Types.h>
+
+struct Tile;
+
+// Parsing for command line options. Each feature parses its own options with a ParseOption
+// function that the main loop offers every option to in turn, given the argument after it as
+// the value, which is null for the last argument.
+//
+namespace CommandLine
+{
+	// What a parser made of an option
+	//
+	enum class Match
+	{
+		// Not one of the parser's options
+		//
+		None,
+
+		// A flag, which doesn't take the value
+		//
+		Flag,
+
+		// An option with a good value, which takes the value
+		//
+		Value,
+
+		// An option with a missing or bad value
+		//
+		Invalid
+	};
+
+	// Return true if the option has the name, ignoring case
+	//
+	bool Is(const char* option, const char* name);
+
+	// Set a flag, which is always a Flag match
+	//
+	Match Flag(bool& result, bool value = true);
+
+	// Return Value if the value was parsed, or Invalid if it wasn't
+	//
+	Match Parsed(bool valid);
+
+	// Store a text value, which is Invalid if it's missing
+	//
+	Match Text(const char*& result, const char* text);
+
+	// Parse a number in the range [min, max]
+	//
+	bool ParseInt(int& value, const char* text, int min, int max);
+	bool ParseFloat(float& value, const char* text, float min, float max);
+
+	// Parse a region given as x,y,w,h
+	//
+	bool ParseRegion(Tile& region, const char* text);
+
+	// Parse a range given as first:last
+	//
+	bool ParseRange(int& first, int& last, const char* text);
+
+	// Split host:port into its parts
+	//
+	bool ParseAddress(char* host, size_t size, int& port, const char* text);
+}
@@ -0,0 +1,151 @@
+#include <RayTracer/CostMap.h>
+#include <Image/Pfm.h>
+#include <Image/Tga.h>
+#include <Math/Scalar.h>
+#include <Core/Constants.h>
+#include <Core/Memory.h>
+#include <Core/Generic.h>
+#include <Core/String.h>
+#include <Core/Log.h>
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	// Color ramp from cheap to expensive, in display colors
+	//
+	constexpr uint8_t ramp[][3] =
+	{
+		{   0,   0,   0 },
+		{  40,  20, 120 },
+		{ 180,  30, 110 },
+		{ 250, 140,  20 },
+		{ 255, 255, 160 },
+	};
+
+	Bgra FalseColor(float s)
+	{
+		constexpr int segments = countof(ramp) - 1;
+
+		const float position = Clamp(s, 0.0f, 1.0f) * segments;
+
+		const int i = Min(int(position), segments - 1);
+		const float f = position - i;
+
+		uint8_t rgb[3];
+
+		for (int c = 0; c < 3; ++c)
+			rgb[c] = uint8_t(ramp[i][c] + (ramp[i + 1][c] - ramp[i][c]) * f + 0.5f);
+
+		return Bgra(rgb[2], rgb[1], rgb[0]);
+	}
+}
+
+bool CostMap::Save(const char* path, const Image<float>& costs)
+{
+	const char* extension = strrchr(path, '.');
+
+	const int count = costs.w * costs.h;
+
+	if (extension && String::CompareNoCase(extension, ".pfm") == 0)
+	{
+		Image<float3> values(Memory::TempAllocator(), costs.w, costs.h);
+
+		for (int i = 0; i < count; ++i)
+			values[i] = float3(costs[i]);
+
+		return Pfm::SaveImage(path, values);
+	}
+
+	if (extension && String::CompareNoCase(extension, ".tga") == 0)
+	{
+		// Costs vary by orders of magnitude, so they're shown on a log scale. Pixels that
+		// weren't rendered are left black.
+
+		float lo = max_float_value;
+		float hi = 0;
+
+		for (int i = 0; i < count; ++i)
+		{
+			if (costs[i] > 0)
+			{
+				lo = Min(lo, costs[i]);
+				hi = Max(hi, costs[i]);
+			}
+		}
+
+		const float log_lo = hi > 0 ? Log2(lo) : 0;
+		const float range = hi > lo ? Log2(hi) - log_lo : 1;
+
+		Image<Bgra> display(Memory::TempAllocator(), costs.w, costs.h);
+
+		for (int i = 0; i < count; ++i)
+			display[i] = costs[i] > 0 ? FalseColor((Log2(costs[i]) - log_lo) / range) : Bgra(0, 0, 0);
+
+		return Tga::SaveImage(path, display);
+	}
+
+	LOG_ERROR("Can't save %s because the format isn't supported (expected .pfm or .tga)", path);
+
+	return false;
+}
+
+void CostMap::Log(const Image<float>& costs, int tile_size)
+{
+	const int count = costs.w * costs.h;
+
+	if (count == 0)
+		return;
+
+	double total = 0;
+	float highest = 0;
+
+	for (int i = 0; i < count; ++i)
+	{
+		total += costs[i];
+		highest = Max(highest, costs[i]);
+	}
+
+	if (total <= 0)
+		return;
+
+	const double mean = total / count;
+
+	LOG_INFO("Cost: mean = %.0f cycles per pixel, max = %.0f (%.1fx the mean)", mean, highest, highest / mean);
+
+	// Sum the costs over the tiles, to see how unevenly the work is spread between them
+
+	const int tw = (costs.w + tile_size - 1) / tile_size;
+	const int th = (costs.h + tile_size - 1) / tile_size;
+
+	Image<double> tiles(Memory::TempAllocator(), tw, th);
+
+	tiles.Fill(0.0);
+
+	for (int y = 0; y < costs.h; ++y)
+	{
+		for (int x = 0; x < costs.w; ++x)
+			tiles(x / tile_size, y / tile_size) += costs(x, y);
+	}
+
+	int expensive = 0;
+
+	for (int i = 0; i < tw * th; ++i)
+	{
+		if (tiles[i] > tiles[expensive])
+			expensive = i;
+	}
+
+	const int tile_count = tw * th;
+
+	std::sort(tiles.texels, tiles.texels + tile_count, [](double a, double b) { return a > b; });
+
+	const int top = Max(1, tile_count / 10);
+
+	double top_sum = 0;
+
+	for (int i = 0; i < top; ++i)
+		top_sum += tiles[i];
+
+	LOG_INFO("Cost: the most expensive tile is at (%i, %i) with %.1fx the mean, and the top 10%% of tiles take %.1f%% of the time", (expensive % tw) * tile_size, (expensive / tw) * tile_size, tiles[0] * tile_count / total, 100 * top_sum / total);
+}
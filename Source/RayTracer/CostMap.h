@@ -0,0 +1,18 @@
+#pragma once
+
+#include <Image/Image.h>
+
+// Output for the cycles the renderer spent on each pixel, to find the expensive parts of a
+// frame, such as long specular chains, when tuning sampling and tile scheduling.
+//
+namespace CostMap
+{
+	// Save the costs as .pfm (cycles per pixel in every channel) or .tga (false color on a log
+	// scale from the cheapest to the most expensive pixel), chosen by extension
+	//
+	bool Save(const char* path, const Image<float>& costs);
+
+	// Log the spread of the costs over pixels and over tiles of the given size
+	//
+	void Log(const Image<float>& costs, int tile_size);
+}
@@ -0,0 +1,359 @@
+#include <RayTracer/Denoiser.h>
+#include <RayTracer/Scheduler.h>
+#include <RayTracer/Aov.h>
+#include <System/Time.h>
+#include <Core/Memory.h>
+#include <Core/Scratch.h>
+#include <Core/Generic.h>
+#include <Core/Log.h>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define DENOISER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	// Rows filtered by each task
+	//
+	constexpr int band_height = 16;
+
+	// Smallest albedo divided out, so that black surfaces and the sky keep their radiance
+	//
+	constexpr float min_albedo = 0.01f;
+
+	// B-spline kernel weights for taps -2 to +2
+	//
+	constexpr float kernel[5] = { 1.0f / 16, 1.0f / 4, 3.0f / 8, 1.0f / 4, 1.0f / 16 };
+
+	// Approximate exp(x) for x <= 0. The vector kernel below performs exactly the same operations
+	// in the same order, so both produce identical results.
+	//
+	float ExpNegative(float x)
+	{
+		x = x > -80.0f ? x : -80.0f;
+
+		const float t = x * 1.442695041f;
+		const int i = int(t) - (float(int(t)) > t);
+		const float f = t - float(i);
+
+		const float p = 1.0f + f * (0.6931472f + f * (0.2402265f + f * (0.05550411f + f * (0.009618129f + f * 0.001333355f))));
+
+		const int32_t bits = (i + 127) << 23;
+
+		float scale;
+		memcpy(&scale, &bits, sizeof(scale));
+
+		return p * scale;
+	}
+
+	struct Pass
+	{
+		int w = 0;
+		int h = 0;
+
+		// Distance between taps in pixels
+		//
+		int step = 1;
+
+		// Reciprocals of the squared sigmas
+		//
+		float color_scale = 0;
+		float normal_scale = 0;
+		float depth_scale = 0;
+
+		// Color planes to read and write
+		//
+		const float* source[3] = {};
+		float* destination[3] = {};
+
+		// Guide planes
+		//
+		const float* normal[3] = {};
+		const float* depth = nullptr;
+	};
+
+	// Add the weighted taps at an offset for pixels [begin, end) of a row
+	//
+	void AddTaps(const Pass& pass, int p, int q, int begin, int end, float h, float* sums[4])
+	{
+		const float* r = pass.source[0];
+		const float* g = pass.source[1];
+		const float* b = pass.source[2];
+		const float* nx = pass.normal[0];
+		const float* ny = pass.normal[1];
+		const float* nz = pass.normal[2];
+		const float* z = pass.depth;
+
+		int x = begin;
+
+#ifdef DENOISER_SSE2
+		const __m128 color_scale = _mm_set1_ps(pass.color_scale);
+		const __m128 normal_scale = _mm_set1_ps(pass.normal_scale);
+		const __m128 depth_scale = _mm_set1_ps(pass.depth_scale);
+		const __m128 weight = _mm_set1_ps(h);
+		const __m128 epsilon = _mm_set1_ps(1.0e-4f);
+		const __m128 lowest = _mm_set1_ps(-80.0f);
+		const __m128 log2e = _mm_set1_ps(1.442695041f);
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 c1 = _mm_set1_ps(0.6931472f);
+		const __m128 c2 = _mm_set1_ps(0.2402265f);
+		const __m128 c3 = _mm_set1_ps(0.05550411f);
+		const __m128 c4 = _mm_set1_ps(0.009618129f);
+		const __m128 c5 = _mm_set1_ps(0.001333355f);
+		const __m128i bias = _mm_set1_epi32(127);
+
+		for (; x + 4 <= end; x += 4)
+		{
+			const int i = p + x;
+			const int j = q + x;
+
+			const __m128 rq = _mm_loadu_ps(r + j);
+			const __m128 gq = _mm_loadu_ps(g + j);
+			const __m128 bq = _mm_loadu_ps(b + j);
+
+			const __m128 dr = _mm_sub_ps(rq, _mm_loadu_ps(r + i));
+			const __m128 dg = _mm_sub_ps(gq, _mm_loadu_ps(g + i));
+			const __m128 db = _mm_sub_ps(bq, _mm_loadu_ps(b + i));
+			const __m128 dx = _mm_sub_ps(_mm_loadu_ps(nx + j), _mm_loadu_ps(nx + i));
+			const __m128 dy = _mm_sub_ps(_mm_loadu_ps(ny + j), _mm_loadu_ps(ny + i));
+			const __m128 dz = _mm_sub_ps(_mm_loadu_ps(nz + j), _mm_loadu_ps(nz + i));
+
+			const __m128 zp = _mm_loadu_ps(z + i);
+			const __m128 dd = _mm_div_ps(_mm_sub_ps(_mm_loadu_ps(z + j), zp), _mm_add_ps(zp, epsilon));
+
+			const __m128 color = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)), _mm_mul_ps(db, db));
+			const __m128 normal = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+			const __m128 depth = _mm_mul_ps(dd, dd);
+
+			__m128 e = _mm_sub_ps(_mm_setzero_ps(), _mm_add_ps(_mm_add_ps(_mm_mul_ps(color, color_scale), _mm_mul_ps(normal, normal_scale)), _mm_mul_ps(depth, depth_scale)));
+
+			// exp(e) as 2^t, split into a power of two and a polynomial for the fraction
+
+			e = _mm_max_ps(e, lowest);
+
+			const __m128 t = _mm_mul_ps(e, log2e);
+			const __m128i truncated = _mm_cvttps_epi32(t);
+			const __m128 above = _mm_cmpgt_ps(_mm_cvtepi32_ps(truncated), t);
+			const __m128i floored = _mm_add_epi32(truncated, _mm_castps_si128(above));
+			const __m128 f = _mm_sub_ps(t, _mm_cvtepi32_ps(floored));
+
+			__m128 poly = _mm_add_ps(c4, _mm_mul_ps(f, c5));
+			poly = _mm_add_ps(c3, _mm_mul_ps(f, poly));
+			poly = _mm_add_ps(c2, _mm_mul_ps(f, poly));
+			poly = _mm_add_ps(c1, _mm_mul_ps(f, poly));
+			poly = _mm_add_ps(one, _mm_mul_ps(f, poly));
+
+			const __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(floored, bias), 23));
+
+			const __m128 w = _mm_mul_ps(weight, _mm_mul_ps(poly, scale));
+
+			_mm_storeu_ps(sums[0] + x, _mm_add_ps(_mm_loadu_ps(sums[0] + x), _mm_mul_ps(w, rq)));
+			_mm_storeu_ps(sums[1] + x, _mm_add_ps(_mm_loadu_ps(sums[1] + x), _mm_mul_ps(w, gq)));
+			_mm_storeu_ps(sums[2] + x, _mm_add_ps(_mm_loadu_ps(sums[2] + x), _mm_mul_ps(w, bq)));
+			_mm_storeu_ps(sums[3] + x, _mm_add_ps(_mm_loadu_ps(sums[3] + x), w));
+		}
+#endif
+
+		for (; x < end; ++x)
+		{
+			const int i = p + x;
+			const int j = q + x;
+
+			const float dr = r[j] - r[i];
+			const float dg = g[j] - g[i];
+			const float db = b[j] - b[i];
+			const float dx = nx[j] - nx[i];
+			const float dy = ny[j] - ny[i];
+			const float dz = nz[j] - nz[i];
+			const float dd = (z[j] - z[i]) / (z[i] + 1.0e-4f);
+
+			const float color = dr * dr + dg * dg + db * db;
+			const float normal = dx * dx + dy * dy + dz * dz;
+			const float depth = dd * dd;
+
+			const float w = h * ExpNegative(-(color * pass.color_scale + normal * pass.normal_scale + depth * pass.depth_scale));
+
+			sums[0][x] += w * r[j];
+			sums[1][x] += w * g[j];
+			sums[2][x] += w * b[j];
+			sums[3][x] += w;
+		}
+	}
+
+	void FilterBand(void* context, int band)
+	{
+		const Pass& pass = *static_cast<const Pass*>(context);
+
+		const int w = pass.w;
+
+		ScratchScope scratch;
+
+		float* sums[4];
+
+		for (float*& sum : sums)
+			sum = scratch.NewArray<float>(w);
+
+		const int y0 = band * band_height;
+		const int y1 = Min(y0 + band_height, pass.h);
+
+		for (int y = y0; y < y1; ++y)
+		{
+			for (float* sum : sums)
+				memset(sum, 0, sizeof(float) * w);
+
+			for (int ty = -2; ty <= 2; ++ty)
+			{
+				const int qy = y + ty * pass.step;
+
+				if (qy < 0 || qy >= pass.h)
+					continue;
+
+				for (int tx = -2; tx <= 2; ++tx)
+				{
+					// Taps that fall outside the image are skipped, the rest are renormalized
+
+					const int offset = tx * pass.step;
+
+					const int begin = Max(0, -offset);
+					const int end = Min(w, w - offset);
+
+					if (begin < end)
+						AddTaps(pass, y * w, qy * w + offset, begin, end, kernel[ty + 2] * kernel[tx + 2], sums);
+				}
+			}
+
+			// The center tap always has a weight of at least kernel[2]^2
+
+			for (int x = 0; x < w; ++x)
+			{
+				const float normalization = 1.0f / sums[3][x];
+
+				for (int c = 0; c < 3; ++c)
+					pass.destination[c][y * w + x] = sums[c][x] * normalization;
+			}
+		}
+	}
+}
+
+bool Denoiser::HasGuides(const AovBuffer& aovs)
+{
+	return aovs.IsEnabled(Aov::Albedo) && aovs.IsEnabled(Aov::Normal) && aovs.IsEnabled(Aov::Depth);
+}
+
+void Denoiser::Run(Allocator& allocator, Image<float3>& radiance, const AovBuffer& aovs, Scheduler& scheduler, const Settings& settings)
+{
+	ASSERT(HasGuides(aovs), "The denoiser needs the albedo, normal and depth AOVs");
+	ASSERT(aovs.w == radiance.w && aovs.h == radiance.h);
+
+	Memory::TagScope tag(Memory::Tag::Framebuffers);
+
+	const uint64_t start = Time::Now();
+
+	const int w = radiance.w;
+	const int h = radiance.h;
+	const int count = w * h;
+
+	// Split the frame into planes so that runs of pixels can be loaded as vectors: two sets of
+	// color planes to ping-pong between, the normal and depth guides, and the albedo
+
+	Array<float> planes(allocator, 10 * count);
+
+	float* colors[2][3];
+
+	for (int c = 0; c < 3; ++c)
+	{
+		colors[0][c] = planes.values + c * count;
+		colors[1][c] = planes.values + (3 + c) * count;
+	}
+
+	float* normal[3] = { planes.values + 6 * count, planes.values + 7 * count, planes.values + 8 * count };
+	float* depth = planes.values + 9 * count;
+
+	Image<float3> albedo(allocator, w, h);
+
+	aovs.Resolve(albedo, Aov::Albedo);
+
+	{
+		Image<float3> guide(allocator, w, h);
+
+		aovs.Resolve(guide, Aov::Normal);
+
+		for (int i = 0; i < count; ++i)
+		{
+			for (int c = 0; c < 3; ++c)
+				normal[c][i] = guide[i].values[c];
+		}
+
+		aovs.Resolve(guide, Aov::Depth);
+
+		for (int i = 0; i < count; ++i)
+			depth[i] = guide[i].x;
+	}
+
+	for (int i = 0; i < count; ++i)
+	{
+		for (int c = 0; c < 3; ++c)
+			colors[0][c][i] = radiance[i].values[c] * settings.exposure / Max(albedo[i].values[c], min_albedo);
+	}
+
+	// Every task of an iteration reads the same source planes, so iterations run one after
+	// another with the scheduler waiting in between
+
+	const int band_count = (h + band_height - 1) / band_height;
+
+	Array<float> priorities(Memory::TempAllocator(), band_count);
+
+	for (int i = 0; i < band_count; ++i)
+		priorities[i] = float(band_count - i);
+
+	Pass pass;
+
+	pass.w = w;
+	pass.h = h;
+	pass.normal_scale = 1.0f / Square(settings.normal_sigma);
+	pass.depth_scale = 1.0f / Square(settings.depth_sigma);
+	pass.depth = depth;
+
+	for (int c = 0; c < 3; ++c)
+		pass.normal[c] = normal[c];
+
+	// Denoising is timed here rather than in the render stats, which the scheduler's workers
+	// would otherwise overwrite
+
+	const bool report_stats = scheduler.report_stats;
+
+	scheduler.report_stats = false;
+
+	int current = 0;
+
+	for (int i = 0; i < settings.iterations; ++i)
+	{
+		const float color_sigma = settings.color_sigma / float(1 << i);
+
+		pass.step = 1 << i;
+		pass.color_scale = 1.0f / Square(color_sigma);
+
+		for (int c = 0; c < 3; ++c)
+		{
+			pass.source[c] = colors[current][c];
+			pass.destination[c] = colors[1 - current][c];
+		}
+
+		scheduler.Start(Memory::TempAllocator(), FilterBand, &pass, priorities.values, band_count);
+		scheduler.Wait();
+
+		current = 1 - current;
+	}
+
+	scheduler.report_stats = report_stats;
+
+	for (int i = 0; i < count; ++i)
+	{
+		for (int c = 0; c < 3; ++c)
+			radiance[i].values[c] = colors[current][c][i] * Max(albedo[i].values[c], min_albedo) / settings.exposure;
+	}
+
+	LOG_INFO("Denoised %i x %i in %.3f s with %i iterations", w, h, Time::Elapsed(start, Time::Now()), settings.iterations);
+}
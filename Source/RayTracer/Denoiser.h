@@ -0,0 +1,48 @@
+#pragma once
+
+#include <Image/Image.h>
+#include <Math/Vector.h>
+
+struct AovBuffer;
+struct Scheduler;
+
+// Edge-avoiding a-trous wavelet filter by Dammertz et al., guided by the albedo, normal and
+// depth AOVs:
+//
+// https://jo.dreggn.org/home/2010_atrous.pdf
+//
+// The radiance is divided by the albedo so that texture detail isn't blurred, filtered with a
+// 5x5 B-spline kernel whose taps spread out by a factor of two on every iteration, and then
+// multiplied by the albedo again. Each tap is weighted by how much the color, normal and
+// depth differ from the center pixel.
+//
+namespace Denoiser
+{
+	struct Settings
+	{
+		// Number of filter iterations, covering (4 << iterations) + 1 pixels across
+		//
+		int iterations = 5;
+
+		// Exposure the color differences are measured at, so that the color sigma is in
+		// display units
+		//
+		float exposure = 1;
+
+		// Sigma of the color, normal and relative depth differences. The color sigma halves
+		// on every iteration.
+		//
+		float color_sigma = 0.5f;
+		float normal_sigma = 0.2f;
+		float depth_sigma = 0.05f;
+	};
+
+	// Return true if the AOVs that guide the filter are enabled in the buffer
+	//
+	bool HasGuides(const AovBuffer& aovs);
+
+	// Filter the radiance in place, splitting each iteration into bands of rows for the
+	// scheduler's workers
+	//
+	void Run(Allocator& allocator, Image<float3>& radiance, const AovBuffer& aovs, Scheduler& scheduler, const Settings& settings);
+}
@@ -0,0 +1,628 @@
+#include <RayTracer/Distributed.h>
+#include <RayTracer/RenderTarget.h>
+#include <RayTracer/Renderer.h>
+#include <RayTracer/Stats.h>
+#include <System/Process.h>
+#include <System/Host.h>
+#include <System/Time.h>
+#include <Core/Scratch.h>
+#include <Core/Memory.h>
+#include <Core/Generic.h>
+#include <Core/String.h>
+#include <Core/Log.h>
+
+namespace
+{
+	// Bump whenever the messages below change
+	//
+	constexpr uint32_t protocol_magic = 0x52540003;
+
+	// Tiles queued for each of a worker's threads so that none of them waits on a round trip
+	// for the next one
+	//
+	constexpr int tiles_per_thread = 2;
+
+	// Most tiles queued on a single worker
+	//
+	constexpr int max_pipeline_depth = tiles_per_thread * max_worker_count;
+
+	// Largest tile whose result fits in a message
+	//
+	constexpr int max_tile_size = 16384;
+
+	// Seconds the coordinator waits without any workers before giving up
+	//
+	constexpr float coordinator_timeout = 30.0f;
+
+	// Messages are sent between processes on the same platform, so they are sent as raw structs
+	// without any conversion.
+
+	enum class MessageType : uint32_t
+	{
+		Setup = 1,
+		Ready,
+		Tile,
+		Result,
+		Done
+	};
+
+	struct MessageHeader
+	{
+		MessageType type;
+		uint32_t size;
+	};
+
+	struct ReadyMessage
+	{
+		int32_t threads;
+	};
+
+	struct TileMessage
+	{
+		int32_t task;
+		Tile tile;
+	};
+
+	struct ResultMessage
+	{
+		uint64_t rays;
+		int32_t task;
+		Tile tile;
+	};
+
+	bool SendMessage(const Socket& socket, MessageType type, const void* payload, size_t size)
+	{
+		const MessageHeader header = { type, uint32_t(size) };
+
+		return socket.Send(&header, sizeof(header)) && (size == 0 || socket.Send(payload, size));
+	}
+
+	bool ReceiveMessage(const Socket& socket, MessageType type, void* payload, size_t size)
+	{
+		MessageHeader header;
+
+		if (!socket.Receive(&header, sizeof(header)))
+			return false;
+
+		if (header.type != type || header.size != size)
+		{
+			LOG_ERROR("Unexpected message %u (%u bytes)", uint32_t(header.type), header.size);
+			return false;
+		}
+
+		return socket.Receive(payload, size);
+	}
+
+	bool IsValidTile(Tile tile, const Distributed::Setup& setup)
+	{
+		return tile.x >= 0 && tile.y >= 0 && tile.w > 0 && tile.h > 0 && tile.x + tile.w <= setup.w && tile.y + tile.h <= setup.h && tile.w <= setup.tile_size && tile.h <= setup.tile_size;
+	}
+
+	unsigned long THREAD_ENTRY ConnectionMain(void* parameter)
+	{
+		Distributed::Coordinator::Connection& connection = *static_cast<Distributed::Coordinator::Connection*>(parameter);
+
+		connection.coordinator->Serve(connection);
+
+		return 0;
+	}
+
+	// Streams finished tiles straight back to the coordinator. Each worker thread has its own.
+	//
+	struct SocketTarget : RenderTarget
+	{
+		SocketTarget(Distributed::Worker& worker) : worker(worker)
+		{
+		}
+
+		int GetWidth() const override
+		{
+			return worker.setup.w;
+		}
+
+		int GetHeight() const override
+		{
+			return worker.setup.h;
+		}
+
+		void WriteTile(Tile tile, const float3* radiance) override
+		{
+			connected = worker.Send(task, tile, Stats::Rays - rays, radiance);
+		}
+
+		// Connection to the coordinator
+		//
+		Distributed::Worker& worker;
+
+		// Tile being rendered
+		//
+		int task = 0;
+
+		// Ray count when the tile was started
+		//
+		uint64_t rays = 0;
+
+		// False once a send has failed
+		//
+		bool connected = true;
+	};
+
+	// Everything the render threads of a worker need
+	//
+	struct WorkerContext
+	{
+		Distributed::Worker& worker;
+		const Renderer& renderer;
+		const Camera& camera;
+		const Scene& scene;
+		const Integrator& integrator;
+	};
+
+	// Render tiles from the connection on one of the scheduler's workers until the frame is
+	// complete
+	//
+	void RenderTiles(void* context, int)
+	{
+		const WorkerContext& c = *static_cast<WorkerContext*>(context);
+
+		SocketTarget target(c.worker);
+
+		Tile tile;
+
+		while (target.connected && c.worker.Take(target.task, tile))
+		{
+			target.rays = Stats::Rays;
+
+			c.renderer.RenderTile(target, tile, c.renderer.first_sample, c.renderer.last_sample, c.camera, c.scene, c.integrator);
+		}
+
+		if (!target.connected)
+		{
+			ScopedLock lock(c.worker.receive_mutex);
+			c.worker.lost = true;
+		}
+	}
+
+	// Start worker processes that connect back to the coordinator on this machine, sharing the
+	// threads between them so that the machine isn't oversubscribed. Each worker is pinned to
+	// its own range of processors.
+	//
+	bool SpawnWorkers(int port, int count, int threads)
+	{
+		char address[32];
+		String::Format(address, sizeof(address), "127.0.0.1:%i", port);
+
+		const int total = threads > 0 ? threads : Host::GetCpuCoreCount();
+		const int per_worker = Max(1, total / Max(count, 1));
+
+		char worker_threads[16];
+		String::Format(worker_threads, sizeof(worker_threads), "%i", per_worker);
+
+		for (int i = 0; i < count; ++i)
+		{
+			char offset[16];
+			String::Format(offset, sizeof(offset), "%i", i * per_worker);
+
+			const char* const args[] = { "-worker", address, "-threads", worker_threads, "-processor-offset", offset };
+
+			if (!Process::SpawnSelf(args, countof(args)))
+				return false;
+		}
+
+		return true;
+	}
+}
+
+Distributed::Coordinator::Coordinator(Allocator& allocator, FramebufferTarget& target, const Setup& setup_) :
+	target(target), setup(setup_), tiler(MortonTiler(allocator, setup_.w, setup_.h, setup_.tile_size)), pending(allocator, tiler.count)
+{
+	ASSERT(setup.tile_size <= max_tile_size, "Tiles are too large to send");
+	ASSERT(target.GetWidth() == setup.w && target.GetHeight() == setup.h, "Target doesn't match the setup");
+
+	setup.magic = protocol_magic;
+
+	// Issue tiles in Morton order, so the stack is filled in reverse
+
+	for (int i = 0; i < tiler.count; ++i)
+		pending[i] = tiler.count - 1 - i;
+
+	pending_count = tiler.count;
+
+	for (Connection& connection : connections)
+		connection.coordinator = this;
+}
+
+bool Distributed::Coordinator::Listen(int port)
+{
+	if (!listener.Listen(port))
+		return false;
+
+	LOG_INFO("Waiting for workers on port %i", port);
+
+	return true;
+}
+
+bool Distributed::Coordinator::Run(float timeout)
+{
+	const uint64_t start = Time::Now();
+
+	uint64_t last_active = start;
+
+	int joined = 0;
+
+	bool success = true;
+
+	while (!IsComplete())
+	{
+		if (listener.Poll(100))
+		{
+			Socket socket;
+
+			if (listener.Accept(socket))
+			{
+				Connection* connection = nullptr;
+
+				for (Connection& c : connections)
+				{
+					if (!c.thread.handle)
+					{
+						connection = &c;
+						break;
+					}
+				}
+
+				if (connection)
+				{
+					connection->socket = static_cast<Socket&&>(socket);
+					connection->tiles = 0;
+					connection->active = true;
+					connection->thread = Thread(ConnectionMain, connection);
+
+					++joined;
+				}
+				else
+				{
+					LOG_WARNING("Rejected a worker because there are already %i connected", max_worker_count);
+				}
+			}
+		}
+
+		// Clean up after workers that have gone so that their slots can be reused
+
+		int active = 0;
+
+		for (Connection& connection : connections)
+		{
+			bool finished;
+
+			{
+				ScopedLock lock(mutex);
+				finished = !connection.active;
+			}
+
+			if (finished && connection.thread.handle)
+			{
+				connection.thread.Join();
+				connection.thread = Thread();
+			}
+
+			active += finished ? 0 : 1;
+		}
+
+		if (active > 0)
+		{
+			last_active = Time::Now();
+		}
+		else if (Time::Elapsed(last_active, Time::Now()) > timeout)
+		{
+			LOG_ERROR("No workers connected for %.0f s with %i of %i tiles complete", timeout, completed, tiler.count);
+			success = false;
+			break;
+		}
+	}
+
+	for (Connection& connection : connections)
+	{
+		if (connection.thread.handle)
+		{
+			connection.thread.Join();
+			connection.thread = Thread();
+		}
+	}
+
+	listener.Close();
+
+	const float duration = Time::Elapsed(start, Time::Now());
+
+	LOG_INFO("Distributed render (%i x %i): quality = %i, workers = %i, tiles = %i, reissued = %i, rays = %llu, duration = %.2f s, efficiency = %.2f Mray/s",
+		setup.w, setup.h, setup.quality, joined, tiler.count, reissued, (unsigned long long)rays, duration, rays / (duration * 1000000));
+
+	return success;
+}
+
+void Distributed::Coordinator::Serve(Connection& connection)
+{
+	const int index = int(&connection - connections);
+
+	const Socket& socket = connection.socket;
+
+	int issued[max_pipeline_depth];
+	int count = 0;
+
+	ScratchScope scratch;
+
+	float3* texels = scratch.NewArray<float3>(setup.tile_size * setup.tile_size);
+
+	// Queue enough tiles on the worker to keep every one of its threads busy
+
+	ReadyMessage ready = {};
+
+	bool connected = SendMessage(socket, MessageType::Setup, &setup, sizeof(setup)) && ReceiveMessage(socket, MessageType::Ready, &ready, sizeof(ready));
+
+	const int depth = Clamp(tiles_per_thread * ready.threads, 1, max_pipeline_depth);
+
+	while (connected)
+	{
+		// Keep the worker's queue topped up
+
+		while (connected && count < depth && Take(issued[count]))
+		{
+			const TileMessage message = { issued[count], tiler.GenerateTile(issued[count]).Clip(setup.w, setup.h) };
+
+			++count;
+
+			connected = SendMessage(socket, MessageType::Tile, &message, sizeof(message));
+		}
+
+		if (!connected)
+			break;
+
+		// With nothing issued, wait in case another worker is lost and its tiles come back
+
+		if (count == 0)
+		{
+			if (IsComplete())
+				break;
+
+			Thread::Sleep(10);
+			continue;
+		}
+
+		// Workers render tiles on several threads, so they come back in any order
+
+		MessageHeader header;
+		ResultMessage result;
+
+		connected = socket.Receive(&header, sizeof(header)) && header.type == MessageType::Result && header.size >= sizeof(result) && socket.Receive(&result, sizeof(result));
+
+		if (!connected)
+			break;
+
+		int slot = 0;
+
+		while (slot < count && issued[slot] != result.task)
+			++slot;
+
+		const Tile expected = tiler.GenerateTile(slot < count ? issued[slot] : 0).Clip(setup.w, setup.h);
+
+		const size_t size = sizeof(float3) * expected.w * expected.h;
+
+		if (slot == count || result.tile.x != expected.x || result.tile.y != expected.y || result.tile.w != expected.w || result.tile.h != expected.h || header.size != sizeof(result) + size)
+		{
+			LOG_ERROR("Worker %i returned the wrong tile", index);
+			connected = false;
+			break;
+		}
+
+		connected = socket.Receive(texels, size);
+
+		if (!connected)
+			break;
+
+		target.WriteTile(expected, texels);
+
+		{
+			ScopedLock lock(mutex);
+			++completed;
+			rays += result.rays;
+		}
+
+		++connection.tiles;
+
+		issued[slot] = issued[--count];
+	}
+
+	if (connected)
+	{
+		SendMessage(socket, MessageType::Done, nullptr, 0);
+
+		LOG_INFO("Worker %i finished after %i tiles", index, connection.tiles);
+	}
+	else
+	{
+		LOG_WARNING("Lost worker %i after %i tiles, issuing its %i outstanding tiles again", index, connection.tiles, count);
+
+		Reissue(issued, count);
+	}
+
+	connection.socket.Close();
+
+	ScopedLock lock(mutex);
+	connection.active = false;
+}
+
+bool Distributed::Coordinator::Take(int& task)
+{
+	ScopedLock lock(mutex);
+
+	if (pending_count == 0)
+		return false;
+
+	task = pending[--pending_count];
+
+	return true;
+}
+
+void Distributed::Coordinator::Reissue(const int* tasks, int count)
+{
+	ScopedLock lock(mutex);
+
+	for (int i = count - 1; i >= 0; --i)
+		pending[pending_count++] = tasks[i];
+
+	reissued += count;
+}
+
+bool Distributed::Coordinator::IsComplete()
+{
+	ScopedLock lock(mutex);
+
+	return completed == tiler.count;
+}
+
+bool Distributed::Worker::Connect(const char* address, Setup& setup_)
+{
+	char host[256];
+	int port = 0;
+
+	if (!CommandLine::ParseAddress(host, sizeof(host), port, address))
+	{
+		LOG_ERROR("Bad coordinator address '%s', expected host:port", address);
+		return false;
+	}
+
+	if (!socket.Connect(host, port))
+		return false;
+
+	if (!ReceiveMessage(socket, MessageType::Setup, &setup, sizeof(setup)) || setup.magic != protocol_magic || setup.tile_size <= 0 || setup.tile_size > max_tile_size)
+	{
+		LOG_ERROR("Failed to receive render settings from %s:%i", host, port);
+		socket.Close();
+		return false;
+	}
+
+	LOG_INFO("Connected to %s:%i", host, port);
+
+	setup_ = setup;
+
+	return true;
+}
+
+bool Distributed::Worker::Serve(Renderer& renderer, const Camera& camera, const Scene& scene, const Integrator& integrator)
+{
+	// Each of the scheduler's workers runs a single task that takes tiles from the connection
+	// until the frame is complete, so the threads never wait on each other between tiles
+
+	WorkerContext context = { *this, renderer, camera, scene, integrator };
+
+	Scheduler& scheduler = renderer.scheduler;
+
+	// Tell the coordinator how many threads there are, so that it can queue enough tiles
+
+	const ReadyMessage ready = { scheduler.worker_count };
+
+	if (!SendMessage(socket, MessageType::Ready, &ready, sizeof(ready)))
+	{
+		LOG_ERROR("Lost the connection to the coordinator");
+		return false;
+	}
+
+	LOG_INFO("Rendering on %i threads", scheduler.worker_count);
+
+	const float priorities[max_worker_count] = {};
+
+	tiles = 0;
+	done = false;
+	lost = false;
+
+	scheduler.Start(Memory::TempAllocator(), RenderTiles, &context, priorities, scheduler.worker_count);
+	scheduler.Wait();
+
+	if (lost)
+	{
+		LOG_ERROR("Lost the connection to the coordinator after %i tiles", tiles);
+		return false;
+	}
+
+	LOG_INFO("Frame complete after %i tiles", tiles);
+
+	return true;
+}
+
+bool Distributed::Worker::Take(int& task, Tile& tile)
+{
+	ScopedLock lock(receive_mutex);
+
+	if (done || lost)
+		return false;
+
+	MessageHeader header;
+
+	if (!socket.Receive(&header, sizeof(header)))
+	{
+		lost = true;
+		return false;
+	}
+
+	if (header.type == MessageType::Done)
+	{
+		done = true;
+		return false;
+	}
+
+	TileMessage message;
+
+	if (header.type != MessageType::Tile || header.size != sizeof(message) || !socket.Receive(&message, sizeof(message)) || !IsValidTile(message.tile, setup))
+	{
+		LOG_ERROR("Received a bad tile from the coordinator");
+		lost = true;
+		return false;
+	}
+
+	task = message.task;
+	tile = message.tile;
+
+	++tiles;
+
+	return true;
+}
+
+bool Distributed::Worker::Send(int task, Tile tile, uint64_t rays, const float3* radiance)
+{
+	const ResultMessage result = { rays, task, tile };
+
+	const size_t size = sizeof(float3) * tile.w * tile.h;
+
+	const MessageHeader header = { MessageType::Result, uint32_t(sizeof(result) + size) };
+
+	ScopedLock lock(send_mutex);
+
+	return socket.Send(&header, sizeof(header)) && socket.Send(&result, sizeof(result)) && socket.Send(radiance, size);
+}
+
+CommandLine::Match Distributed::ParseOption(Settings& settings, const char* option, const char* value)
+{
+	if (CommandLine::Is(option, "-coordinator"))
+		return CommandLine::Parsed(CommandLine::ParseInt(settings.coordinator_port, value, 1, 65535));
+	if (CommandLine::Is(option, "-workers"))
+		return CommandLine::Parsed(CommandLine::ParseInt(settings.local_workers, value, 0, max_worker_count));
+	if (CommandLine::Is(option, "-worker"))
+		return CommandLine::Text(settings.worker, value);
+	if (CommandLine::Is(option, "-processor-offset"))
+		return CommandLine::Parsed(CommandLine::ParseInt(settings.processor_offset, value, 0, 65535));
+
+	return CommandLine::Match::None;
+}
+
+bool Distributed::RunCoordinator(Allocator& allocator, FramebufferTarget& target, const Setup& setup, const Settings& settings, int threads)
+{
+	Coordinator coordinator(allocator, target, setup);
+
+	if (!coordinator.Listen(settings.coordinator_port))
+		return false;
+
+	if (!SpawnWorkers(settings.coordinator_port, settings.local_workers, threads))
+		return false;
+
+	return coordinator.Run(coordinator_timeout);
+}
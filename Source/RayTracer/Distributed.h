@@ -0,0 +1,230 @@
+#pragma once
+
+#include <RayTracer/CommandLine.h>
+#include <RayTracer/Tile.h>
+#include <Math/Vector.h>
+#include <System/Socket.h>
+#include <System/Thread.h>
+#include <System/Mutex.h>
+#include <Core/Constants.h>
+#include <Core/Array.h>
+
+struct FramebufferTarget;
+struct Renderer;
+struct Camera;
+struct Scene;
+struct Integrator;
+
+namespace Distributed
+{
+	struct Settings
+	{
+		// Port to hand out tiles to worker processes on, or 0 to render locally
+		//
+		int coordinator_port = 0;
+
+		// Number of worker processes for the coordinator to start on this machine
+		//
+		int local_workers = 0;
+
+		// Coordinator address (host:port) when running as a worker
+		//
+		const char* worker = nullptr;
+
+		// Processor to pin a worker's first render thread to, so that the local workers on a
+		// machine each run on their own processors
+		//
+		int processor_offset = 0;
+	};
+
+	// Render settings sent to each worker when it connects, so that workers need no options
+	// other than the coordinator address
+	//
+	struct Setup
+	{
+		// Identifies the protocol version
+		//
+		uint32_t magic = 0;
+
+		// Resolution in pixels
+		//
+		int32_t w = 0;
+		int32_t h = 0;
+
+		// Render quality
+		//
+		int32_t quality = 1;
+
+		// Max ray depth
+		//
+		int32_t max_depth = 1;
+
+		// Russian roulette depth and throughput threshold
+		//
+		int32_t roulette_depth = 0;
+		float roulette_threshold = 1;
+
+		// Tile size in pixels
+		//
+		int32_t tile_size = 16;
+	};
+
+	struct Coordinator
+	{
+		struct Connection
+		{
+			// Owning coordinator
+			//
+			Coordinator* coordinator = nullptr;
+
+			// Connection to the worker process
+			//
+			Socket socket;
+
+			// Thread feeding the worker with tiles
+			//
+			Thread thread;
+
+			// Number of tiles returned by the worker
+			//
+			int tiles = 0;
+
+			// True until the connection thread has finished
+			//
+			bool active = false;
+		};
+
+		Coordinator(Allocator& allocator, FramebufferTarget& target, const Setup& setup);
+
+		Coordinator(const Coordinator&) = delete;
+		void operator=(const Coordinator&) = delete;
+
+		Coordinator(Coordinator&&) = delete;
+		void operator=(Coordinator&&) = delete;
+
+		// Start accepting workers on the port
+		//
+		bool Listen(int port);
+
+		// Hand out tiles to workers as they connect until the frame is complete. Tiles held by
+		// workers that disconnect are issued again. Fails if no workers have been connected for
+		// the timeout (in seconds).
+		//
+		bool Run(float timeout);
+
+		// Feed tiles to a single worker until the frame is complete or the worker is lost
+		//
+		void Serve(Connection& connection);
+
+		// Take the next tile to issue, returns false if there are none left to issue
+		//
+		bool Take(int& task);
+
+		// Return tiles from a lost worker so they are issued again
+		//
+		void Reissue(const int* tasks, int count);
+
+		// Return true once every tile has been received
+		//
+		bool IsComplete();
+
+		// Frame being assembled
+		//
+		FramebufferTarget& target;
+
+		// Settings for the workers
+		//
+		Setup setup;
+
+		// Tile layout
+		//
+		Tiler tiler;
+
+		// Socket accepting new workers
+		//
+		Socket listener;
+
+		// Guards everything below
+		//
+		Mutex mutex;
+
+		// Stack of tiles still to be issued
+		//
+		Array<int> pending;
+		int pending_count = 0;
+
+		// Number of tiles received
+		//
+		int completed = 0;
+
+		// Number of tiles that had to be issued again
+		//
+		int reissued = 0;
+
+		// Rays cast by all workers
+		//
+		uint64_t rays = 0;
+
+		// Worker connections
+		//
+		Connection connections[max_worker_count];
+	};
+
+	struct Worker
+	{
+		// Connect to a coordinator at host:port and receive the render settings
+		//
+		bool Connect(const char* address, Setup& setup);
+
+		// Render tiles for the coordinator on the renderer's scheduler until it reports that the
+		// frame is complete. Every worker thread takes tiles from the connection and sends them
+		// back as soon as they're done.
+		//
+		bool Serve(Renderer& renderer, const Camera& camera, const Scene& scene, const Integrator& integrator);
+
+		// Receive the next tile to render, returns false once the frame is complete or the
+		// connection is lost
+		//
+		bool Take(int& task, Tile& tile);
+
+		// Send a finished tile, returns false if the connection is lost
+		//
+		bool Send(int task, Tile tile, uint64_t rays, const float3* radiance);
+
+		// Settings received from the coordinator
+		//
+		Setup setup;
+
+		// Connection to the coordinator
+		//
+		Socket socket;
+
+		// Guards receiving from the coordinator and the state below
+		//
+		Mutex receive_mutex;
+
+		// Guards sending to the coordinator
+		//
+		Mutex send_mutex;
+
+		// Number of tiles received
+		//
+		int tiles = 0;
+
+		// Set once the coordinator has reported that the frame is complete, or once the
+		// connection is lost
+		//
+		bool done = false;
+		bool lost = false;
+	};
+
+	// Parse the -coordinator, -workers, -worker and -processor-offset options
+	//
+	CommandLine::Match ParseOption(Settings& settings, const char* option, const char* value);
+
+	// Render the frame into the target on worker processes, starting the local workers first
+	// and sharing the threads between them. Threads is the total for all the local workers, or
+	// 0 for every core.
+	//
+	bool RunCoordinator(Allocator& allocator, FramebufferTarget& target, const Setup& setup, const Settings& settings, int threads);
+}
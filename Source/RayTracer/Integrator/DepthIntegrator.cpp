@@ -1,10 +1,11 @@
 #include <RayTracer/Integrator/DepthIntegrator.h>
 #include <RayTracer/Sampler.h>
+#include <RayTracer/Aov.h>
 #include <RayTracer/Intersection.h>
 #include <RayTracer/Scene.h>
 #include <Math/Ray.h>
 
-float3 DepthIntegrator::Li(Sampler& sampler, Ray ray, const Scene& scene) const
+float3 DepthIntegrator::Li(Sampler& sampler, Ray ray, const Scene& scene, AovSample* aovs) const
 {
 	unused(sampler);
 
@@ -13,5 +14,8 @@ float3 DepthIntegrator::Li(Sampler& sampler, Ray ray, const Scene& scene) const
 	if (!scene.Hit(intersection, ray))
 		return float3(1);
 
+	if (aovs)
+		aovs->depth = intersection.t;
+
 	return float3(intersection.t * depth_scale);
 }
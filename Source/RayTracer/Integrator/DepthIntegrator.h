@@ -9,7 +9,7 @@ struct DepthIntegrator : Integrator
 
 	// Return the radiance for the ray
 	//
-	float3 Li(Sampler& sampler, Ray ray, const Scene& scene) const override;
+	float3 Li(Sampler& sampler, Ray ray, const Scene& scene, AovSample* aovs = nullptr) const override;
 
 	// Depth at which the output is one
 	//
@@ -1,18 +1,26 @@
 #include <RayTracer/Integrator/DirectIntegrator.h>
 #include <RayTracer/Material.h>
 #include <RayTracer/Sampler.h>
+#include <RayTracer/Aov.h>
 #include <RayTracer/Intersection.h>
 #include <RayTracer/Scene.h>
 #include <Math/Ray.h>
 
-float3 DirectIntegrator::Li(Sampler& sampler, Ray ray, const Scene& scene) const
+float3 DirectIntegrator::Li(Sampler& sampler, Ray ray, const Scene& scene, AovSample* aovs) const
 {
 	unused(sampler);
 
 	Intersection intersection;
 
 	if (!scene.Hit(intersection, ray))
-		return scene.SampleEnvironment(ray);
+	{
+		const float3 environment = scene.SampleEnvironment(ray);
+
+		if (aovs)
+			aovs->direct = environment;
+
+		return environment;
+	}
 
 	const float3 p = intersection.point;
 	const float3 v = -ray.d;
@@ -34,5 +42,11 @@ float3 DirectIntegrator::Li(Sampler& sampler, Ray ray, const Scene& scene) const
 		color += li * weight;
 	}
 
+	if (aovs)
+	{
+		aovs->SetSurface(intersection, brdf);
+		aovs->direct = color;
+	}
+
 	return color;
 }
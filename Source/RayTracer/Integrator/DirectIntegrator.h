@@ -8,5 +8,5 @@ struct DirectIntegrator : Integrator
 
 	// Return the radiance for the ray
 	//
-	float3 Li(Sampler& sampler, Ray ray, const Scene& scene) const override;
+	float3 Li(Sampler& sampler, Ray ray, const Scene& scene, AovSample* aovs = nullptr) const override;
 };
@@ -5,12 +5,14 @@
 struct Sampler;
 struct Ray;
 struct Scene;
+struct AovSample;
 
 struct Integrator
 {
 	virtual ~Integrator() {}
 
-	// Return the radiance for the ray
+	// Return the radiance for the ray. If AOVs are given, the integrator fills in the ones it
+	// can for the sample.
 	//
-	virtual float3 Li(Sampler& sampler, Ray ray, const Scene& scene) const = 0;
+	virtual float3 Li(Sampler& sampler, Ray ray, const Scene& scene, AovSample* aovs = nullptr) const = 0;
 };
@@ -1,21 +1,37 @@
 #include <RayTracer/Integrator/PathIntegrator.h>
 #include <RayTracer/Material.h>
 #include <RayTracer/Sampler.h>
+#include <RayTracer/Aov.h>
 #include <RayTracer/Intersection.h>
 #include <RayTracer/Scene.h>
+#include <RayTracer/Stats.h>
+#include <Math/Random.h>
 #include <Math/Ray.h>
+#include <Core/Generic.h>
 
-float3 PathIntegrator::Li(Sampler& sampler, Ray ray, const Scene& scene) const
+float3 PathIntegrator::Li(Sampler& sampler, Ray ray, const Scene& scene, AovSample* aovs) const
 {
 	float3 color = { 0, 0, 0 };
 	float3 coefficient = { 1, 1, 1 };
 
+	Stats::PathEnd end = Stats::PathEnd::MaxDepth;
+	int bounces = max_depth;
+
 	for (int i = 0; i < max_depth; ++i)
 	{
 		Intersection intersection;
 
 		if (!scene.Hit(intersection, ray))
-			return color + scene.SampleEnvironment(ray) * coefficient;
+		{
+			color += scene.SampleEnvironment(ray) * coefficient;
+
+			if (aovs && i == 0)
+				aovs->direct = color;
+
+			end = Stats::PathEnd::Escaped;
+			bounces = i;
+			break;
+		}
 
 		const float3 p = intersection.point;
 		const float3 v = -ray.d;
@@ -40,6 +56,12 @@ float3 PathIntegrator::Li(Sampler& sampler, Ray ray, const Scene& scene) const
 			color += li * weight * coefficient;
 		}
 
+		if (aovs && i == 0)
+		{
+			aovs->SetSurface(intersection, brdf);
+			aovs->direct = color;
+		}
+
 		// Evaluate the material for the future interactions
 
 		float3 l;
@@ -49,11 +71,36 @@ float3 PathIntegrator::Li(Sampler& sampler, Ray ray, const Scene& scene) const
 
 		coefficient *= weight;
 
+		// Russian roulette: past the roulette depth, end the path with a chance that grows as its
+		// throughput falls below the threshold, and scale up the paths that survive so that the
+		// estimate stays unbiased. The choice uses the per-sample random stream rather than a
+		// sampler dimension, so the sample patterns of later bounces don't depend on it.
+
+		if (roulette_depth > 0 && i + 1 >= roulette_depth && i + 1 < max_depth)
+		{
+			const float throughput = Max(coefficient.x, coefficient.y, coefficient.z);
+			const float survival = throughput > 0 ? Clamp(throughput / roulette_threshold, min_survival, max_survival) : 0.0f;
+
+			if (Random::Real() >= survival)
+			{
+				end = Stats::PathEnd::Roulette;
+				bounces = i + 1;
+				break;
+			}
+
+			coefficient /= survival;
+		}
+
 		// Set up the ray for the next bounce
 
 		ray.p = p;
 		ray.d = l;
 	}
 
+	Stats::OnPathEnd(bounces, end);
+
+	if (aovs)
+		aovs->indirect = color - aovs->direct;
+
 	return color;
 }
@@ -5,12 +5,30 @@
 struct PathIntegrator : Integrator
 {
 	PathIntegrator(int max_depth) : max_depth(max_depth) {}
+	PathIntegrator(int max_depth, int roulette_depth, float roulette_threshold) : max_depth(max_depth), roulette_depth(roulette_depth), roulette_threshold(roulette_threshold) {}
 
 	// Return the radiance for the ray
 	//
-	float3 Li(Sampler& sampler, Ray ray, const Scene& scene) const override;
+	float3 Li(Sampler& sampler, Ray ray, const Scene& scene, AovSample* aovs = nullptr) const override;
 
 	// Max ray depth
 	//
 	int max_depth = 3;
+
+	// Number of bounces traced before paths are ended at random, or 0 to trace every path to
+	// the max depth
+	//
+	int roulette_depth = 3;
+
+	// Throughput below which the chance of a path surviving each later bounce falls in
+	// proportion to it. Paths that carry little of the pixel's radiance are cut short, while
+	// those that still carry a lot are rarely ended, which would add more noise than it saves.
+	//
+	float roulette_threshold = 0.5f;
+
+	// Range of the chance of surviving roulette. The upper bound ends paths whose throughput
+	// stays high, and the lower bound limits the weight given to the paths that survive.
+	//
+	float min_survival = 0.05f;
+	float max_survival = 0.95f;
 };
@@ -0,0 +1,500 @@
+#include <RayTracer/Kernels.h>
+#include <RayTracer/Brdf/Microfacet.h>
+#include <RayTracer/Brdf/UberBrdf.h>
+#include <RayTracer/Intersection.h>
+#include <RayTracer/Material.h>
+#include <RayTracer/Profiler.h>
+#include <RayTracer/Sampler.h>
+#include <RayTracer/Camera.h>
+#include <RayTracer/Scene.h>
+#include <Math/Random.h>
+#include <System/File.h>
+#include <Core/Constants.h>
+#include <Core/Writer.h>
+#include <Core/String.h>
+#include <Core/Log.h>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+	// Inputs recorded for each kernel, and the times each kernel is run over all of them
+	//
+	constexpr int max_inputs = 4096;
+	constexpr int pass_count = 64;
+
+	// Slowdown of the fastest pass against the baseline's that's reported as a regression. The
+	// fastest pass is the one least disturbed by interrupts and other processes, but it still
+	// moves by a few percent between runs of the same build.
+	//
+	constexpr double regression_threshold = 0.10;
+
+	struct Hit
+	{
+		const Shape* shape;
+		float t;
+		Ray ray;
+	};
+
+	struct BrdfInput
+	{
+		UberBrdf brdf;
+		float3 l;
+		float3 v;
+		float2 sample;
+	};
+
+	struct TextureInput
+	{
+		const Texture<float3>* texture;
+		float2 uv;
+	};
+
+	struct PermuteInput
+	{
+		uint i;
+		uint l;
+		uint p;
+	};
+
+	struct PixelInput
+	{
+		int x;
+		int y;
+		int sample;
+	};
+
+	// Reservoir of inputs, so that the recorded inputs are spread over the whole frame
+	// rather than taken from the first few rows
+	//
+	template<typename T>
+	struct Reservoir
+	{
+		void Add(const T& input)
+		{
+			if (items.size() < max_inputs)
+				items.push_back(input);
+			else
+			{
+				const uint i = uint(CorrelatedMultiJitterSampler::RandomReal(seen, 0x2c1b3c6d) * (seen + 1));
+
+				if (i < max_inputs)
+					items[i] = input;
+			}
+
+			++seen;
+		}
+
+		int Size() const
+		{
+			return int(items.size());
+		}
+
+		const T& operator[](int i) const
+		{
+			return items[i];
+		}
+
+		std::vector<T> items;
+
+		uint seen = 0;
+	};
+
+	struct Inputs
+	{
+		Reservoir<Ray> rays;
+		Reservoir<Hit> hits;
+		Reservoir<BrdfInput> brdfs;
+		Reservoir<TextureInput> textures;
+		Reservoir<PermuteInput> permutes;
+		Reservoir<PixelInput> pixels;
+		Reservoir<float2> angles;
+	};
+
+	// Trace paths the way PathIntegrator does, recording the inputs to each kernel along the way
+	//
+	void RecordInputs(Inputs& inputs, const Scene& scene, const Camera& camera)
+	{
+		constexpr int w = 64;
+		constexpr int h = 32;
+		constexpr int quality = 2;
+		constexpr int max_depth = 4;
+
+		CorrelatedMultiJitterSampler sampler(quality);
+
+		for (int y = 0; y < h; ++y)
+		{
+			for (int x = 0; x < w; ++x)
+			{
+				sampler.StartPixel(x, y);
+
+				for (int s = 0; s < sampler.GetSampleCount(); ++s)
+				{
+					Random::SetSeed(uint64_t(uint32_t(sampler.pattern)) << 32 | uint32_t(s));
+
+					sampler.StartSample();
+
+					inputs.pixels.Add({ x, y, s });
+					inputs.permutes.Add({ uint(s), uint(quality * quality), uint(sampler.pattern) * 0x51633e2d });
+
+					const float2 pixel = sampler.Get();
+
+					Ray ray = camera.GenerateRay((x + pixel.x) * 2.0f / w - 1.0f, (y + pixel.y) * 2.0f / h - 1.0f, sampler.Get());
+
+					for (int i = 0; i < max_depth; ++i)
+					{
+						inputs.rays.Add(ray);
+
+						Intersection intersection;
+
+						if (!scene.Hit(intersection, ray))
+						{
+							inputs.angles.Add({ scene.atmosphere.altitude, ACos(ray.d.y) });
+							break;
+						}
+
+						// Find the shape that was hit so that PopulateIntersection can be replayed
+
+						const Shape* shape = nullptr;
+						float t = max_float_value;
+
+						for (const auto& sphere : scene.spheres)
+						{
+							if (sphere.Hit(t, ray))
+								shape = &sphere;
+						}
+
+						for (const auto& plane : scene.planes)
+						{
+							if (plane.Hit(t, ray))
+								shape = &plane;
+						}
+
+						if (shape)
+							inputs.hits.Add({ shape, t, ray });
+
+						const Material& material = *intersection.material;
+
+						inputs.textures.Add({ material.color, intersection.uv });
+
+						const UberBrdf brdf = material.CreateBrdf(intersection.uv, intersection.CalculateTransform());
+
+						const float3 v = -ray.d;
+
+						for (const auto& light : scene.lights)
+						{
+							inputs.rays.Add(Ray(intersection.point, light.direction));
+							inputs.brdfs.Add({ brdf, light.direction, v, sampler.Get() });
+						}
+
+						float3 l;
+
+						brdf.Sample(l, v, sampler.Get());
+
+						ray = Ray(intersection.point, l);
+					}
+				}
+			}
+		}
+	}
+
+	struct Result
+	{
+		const char* name = nullptr;
+
+		// Inputs timed in each pass
+		//
+		int calls = 0;
+
+		// Cycles per call over the fastest and the median pass
+		//
+		double min = 0;
+		double median = 0;
+	};
+
+	// Results are kept alive through a volatile sink so that the kernels aren't optimized away
+	//
+	volatile float sink = 0;
+
+	template<typename Function>
+	Result Time(const char* name, int calls, Function function)
+	{
+		double cycles[pass_count];
+
+		for (int pass = 0; pass < pass_count; ++pass)
+		{
+			const uint64_t begin = Profiler::ReadCycles();
+
+			float sum = 0;
+
+			for (int i = 0; i < calls; ++i)
+				sum += function(i);
+
+			const uint64_t end = Profiler::ReadCycles();
+
+			sink = sink + sum;
+
+			cycles[pass] = double(end - begin) / Max(calls, 1);
+		}
+
+		std::sort(cycles, cycles + pass_count);
+
+		Result result;
+
+		result.name = name;
+		result.calls = calls;
+		result.min = cycles[0];
+		result.median = cycles[pass_count / 2];
+
+		return result;
+	}
+
+	int TimeKernels(Result* results, const Inputs& inputs, const Scene& scene)
+	{
+		int count = 0;
+
+		const int rays = inputs.rays.Size();
+
+		if (!scene.spheres.empty())
+		{
+			const int sphere_count = int(scene.spheres.size());
+
+			results[count++] = Time("SphereShape::Hit", rays, [&](int i)
+			{
+				float t = max_float_value;
+				return scene.spheres[i % sphere_count].Hit(t, inputs.rays[i]) ? t : 0.0f;
+			});
+		}
+
+		if (!scene.planes.empty())
+		{
+			const int plane_count = int(scene.planes.size());
+
+			results[count++] = Time("PlaneShape::Hit", rays, [&](int i)
+			{
+				float t = max_float_value;
+				return scene.planes[i % plane_count].Hit(t, inputs.rays[i]) ? t : 0.0f;
+			});
+		}
+
+		results[count++] = Time("Shape::PopulateIntersection", inputs.hits.Size(), [&](int i)
+		{
+			const Hit& hit = inputs.hits[i];
+
+			Intersection intersection;
+
+			hit.shape->PopulateIntersection(intersection, hit.t, hit.ray);
+
+			return intersection.uv.x + intersection.normal.y;
+		});
+
+		results[count++] = Time("Microfacet::CalculateNormal", inputs.brdfs.Size(), [&](int i)
+		{
+			const BrdfInput& input = inputs.brdfs[i];
+
+			return Microfacet::CalculateNormal(input.v, input.brdf.normal, input.sample, input.brdf.alpha).x;
+		});
+
+		results[count++] = Time("UberBrdf::Evaluate", inputs.brdfs.Size(), [&](int i)
+		{
+			const BrdfInput& input = inputs.brdfs[i];
+
+			return input.brdf.Evaluate(input.l, input.v).x;
+		});
+
+		results[count++] = Time("UberBrdf::Sample", inputs.brdfs.Size(), [&](int i)
+		{
+			const BrdfInput& input = inputs.brdfs[i];
+
+			float3 l;
+
+			return input.brdf.Sample(l, input.v, input.sample).x + l.x;
+		});
+
+		results[count++] = Time("CorrelatedMultiJitterSampler::Get", inputs.pixels.Size(), [&](int i)
+		{
+			const PixelInput& input = inputs.pixels[i];
+
+			CorrelatedMultiJitterSampler sampler(2);
+
+			sampler.StartPixel(input.x, input.y);
+			sampler.SetSample(input.sample);
+			sampler.StartSample();
+
+			return sampler.Get().x;
+		});
+
+		results[count++] = Time("CorrelatedMultiJitterSampler::Permute", inputs.permutes.Size(), [&](int i)
+		{
+			const PermuteInput& input = inputs.permutes[i];
+
+			return float(CorrelatedMultiJitterSampler::Permute(input.i, input.l, input.p));
+		});
+
+		const Medium& rayleigh = scene.atmosphere.rayleigh;
+
+		results[count++] = Time("Lut::Sample (1D)", inputs.angles.Size(), [&](int i)
+		{
+			return rayleigh.inscattering.Sample(inputs.angles[i].y).x;
+		});
+
+		results[count++] = Time("Lut::Sample (2D)", inputs.angles.Size(), [&](int i)
+		{
+			return rayleigh.depth.Sample(inputs.angles[i].x, inputs.angles[i].y);
+		});
+
+		results[count++] = Time("ImageTexture::Sample", inputs.textures.Size(), [&](int i)
+		{
+			const TextureInput& input = inputs.textures[i];
+
+			return input.texture->Sample(input.uv).x;
+		});
+
+		return count;
+	}
+
+	bool Save(const char* path, const Result* results, int count)
+	{
+		File file;
+
+		if (!file.OpenForWrite(path, 1_KiB + 256 * size_t(count)))
+		{
+			LOG_ERROR("Failed to save kernel results to %s", path);
+			return false;
+		}
+
+		Writer writer(file.contents, file.size);
+
+		// One kernel per line so that baselines can be read back without a JSON parser
+
+		writer.WriteString("{\n\t\"kernels\": [\n");
+
+		for (int i = 0; i < count; ++i)
+		{
+			const Result& result = results[i];
+
+			writer.WriteString("\t\t{ \"name\": \"%s\", \"calls\": %i, \"min_cycles\": %.2f, \"median_cycles\": %.2f }%s\n", result.name, result.calls, result.min, result.median, i + 1 < count ? "," : "");
+		}
+
+		writer.WriteString("\t]\n}\n");
+
+		file.Close(writer.BytesWritten());
+
+		return true;
+	}
+
+	// Find the fastest pass cycles for the kernel in a results file saved by Save, or return a
+	// negative value if it isn't there
+	//
+	double FindBaseline(const char* contents, size_t size, const char* name)
+	{
+		char key[128];
+
+		String::Format(key, sizeof(key), "\"name\": \"%s\"", name);
+
+		const char* end = contents + size;
+
+		for (const char* line = contents; line < end; )
+		{
+			const char* next = static_cast<const char*>(memchr(line, '\n', end - line));
+
+			if (!next)
+				next = end;
+
+			const char* field = "\"min_cycles\": ";
+
+			char buffer[256];
+
+			if (size_t(next - line) < sizeof(buffer))
+			{
+				memcpy(buffer, line, next - line);
+				buffer[next - line] = 0;
+
+				const char* value = strstr(buffer, field);
+
+				if (value && strstr(buffer, key))
+					return strtod(value + strlen(field), nullptr);
+			}
+
+			line = next + 1;
+		}
+
+		return -1;
+	}
+
+	bool Compare(const char* baseline, const Result* results, int count)
+	{
+		File file;
+
+		if (!file.OpenForRead(baseline))
+		{
+			LOG_ERROR("Failed to load the kernel baseline from %s", baseline);
+			return false;
+		}
+
+		const char* contents = static_cast<const char*>(file.contents);
+
+		int regressions = 0;
+
+		for (int i = 0; i < count; ++i)
+		{
+			const Result& result = results[i];
+
+			const double base = FindBaseline(contents, file.size, result.name);
+
+			if (base <= 0)
+			{
+				LOG_INFO("  %-38s %9.2f cycles (not in the baseline)", result.name, result.min);
+				continue;
+			}
+
+			const double change = result.min / base - 1;
+
+			const bool regressed = change > regression_threshold;
+
+			LOG_INFO("  %-38s %9.2f cycles vs %9.2f, %+6.1f%%%s", result.name, result.min, base, 100 * change, regressed ? "  REGRESSION" : "");
+
+			regressions += regressed;
+		}
+
+		if (regressions > 0)
+			LOG_WARNING("%i kernels are more than %.0f%% slower than %s", regressions, 100 * regression_threshold, baseline);
+
+		return true;
+	}
+}
+
+CommandLine::Match Kernels::ParseOption(Settings& settings, const char* option, const char* value)
+{
+	if (CommandLine::Is(option, "-kernels"))
+		return CommandLine::Text(settings.path, value);
+	if (CommandLine::Is(option, "-baseline"))
+		return CommandLine::Text(settings.baseline, value);
+
+	return CommandLine::Match::None;
+}
+
+bool Kernels::Run(const Scene& scene, const Camera& camera, const Settings& settings)
+{
+	Inputs inputs;
+
+	RecordInputs(inputs, scene, camera);
+
+	LOG_INFO("Recorded %i rays, %i hits, %i brdf and %i texture inputs", inputs.rays.Size(), inputs.hits.Size(), inputs.brdfs.Size(), inputs.textures.Size());
+
+	Result results[16];
+
+	const int count = TimeKernels(results, inputs, scene);
+
+	if (!settings.baseline)
+	{
+		for (int i = 0; i < count; ++i)
+			LOG_INFO("  %-38s %9.2f cycles (min %.2f) over %i calls", results[i].name, results[i].median, results[i].min, results[i].calls);
+	}
+	else if (!Compare(settings.baseline, results, count))
+		return false;
+
+	return Save(settings.path, results, count);
+}
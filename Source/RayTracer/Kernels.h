@@ -0,0 +1,35 @@
+#pragma once
+
+#include <RayTracer/CommandLine.h>
+
+struct Scene;
+struct Camera;
+
+// Microbenchmarks for the hot functions of the renderer. Inputs are recorded by tracing paths
+// through the scene, so that each kernel sees the same mix of hits, misses, materials and
+// angles as it would in a real render, then each kernel is timed over its inputs in cycles.
+// Results can be compared against a baseline saved by an earlier build to check a change to
+// one function in isolation.
+//
+namespace Kernels
+{
+	struct Settings
+	{
+		// Output path for the results (.json), or null to render normally
+		//
+		const char* path = nullptr;
+
+		// Results saved by an earlier build to compare against, or null for none
+		//
+		const char* baseline = nullptr;
+	};
+
+	// Parse the -kernels and -baseline options
+	//
+	CommandLine::Match ParseOption(Settings& settings, const char* option, const char* value);
+
+	// Record inputs from the scene and camera, time all kernels and save the results to the
+	// settings' path. If there's a baseline, the results are also compared against it.
+	//
+	bool Run(const Scene& scene, const Camera& camera, const Settings& settings);
+}
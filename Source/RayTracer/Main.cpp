@@ -1,32 +1,189 @@
 #include <RayTracer/Integrator/PathIntegrator.h>
+#include <RayTracer/Accumulation.h>
+#include <RayTracer/AllocatorBenchmark.h>
+#include <RayTracer/Aov.h>
+#include <RayTracer/Benchmark.h>
+#include <RayTracer/Checkpoint.h>
+#include <RayTracer/CommandLine.h>
+#include <RayTracer/CostMap.h>
+#include <RayTracer/Denoiser.h>
+#include <RayTracer/Distributed.h>
+#include <RayTracer/Kernels.h>
 #include <RayTracer/Renderer.h>
+#include <RayTracer/Progressive.h>
+#include <RayTracer/RayCapture.h>
+#include <RayTracer/Profiler.h>
+#include <RayTracer/RenderTarget.h>
+#include <RayTracer/StreamingTarget.h>
+#include <RayTracer/ToneMap.h>
 #include <RayTracer/Texture/ConstantTexture.h>
 #include <RayTracer/Texture/ImageTexture.h>
 #include <RayTracer/Material.h>
 #include <RayTracer/Camera.h>
 #include <RayTracer/Scene.h>
+#include <RayTracer/Viewer.h>
 #include <Image/Image.h>
 #include <Image/Tga.h>
 #include <Math/Vector.h>
-#include <System/Input.h>
-#include <System/Window.h>
-#include <System/Dialog.h>
-#include <System/Thread.h>
 #include <System/SystemAllocator.h>
 #include <Core/Log.h>
-#include <Core/Constants.h>
 #include <Core/UnitTest.h>
 #include <Core/Memory.h>
+#include <Core/String.h>
+#include <algorithm>
+#include <cstring>
 
 namespace
 {
-	// Max ray depth
+	// Max number of accumulation files to merge
 	//
-	const int max_depth = 10;
+	constexpr int max_merge_count = 256;
 
-	// Render quality
+	// Max number of regions to render
 	//
-	const int quality = 16;
+	constexpr int max_region_count = 64;
+
+	// Max number of per-pixel cost maps to save
+	//
+	constexpr int max_cost_count = 2;
+
+	// Trace events kept for each worker
+	//
+	constexpr int trace_event_capacity = 128 * 1024;
+
+	struct Options
+	{
+		// Render without a window and save the result to the output path
+		//
+		bool batch = false;
+
+		// Output path for batch renders (.pfm, .tga or .acc for the raw sample sums)
+		//
+		const char* output = "Render.pfm";
+
+		// Resolution in pixels
+		//
+		int w = 1536 / 2;
+		int h = 1024 / 2;
+
+		// Render quality
+		//
+		int quality = 16;
+
+		// Max ray depth
+		//
+		int max_depth = 10;
+
+		// Bounces traced before paths can be ended by Russian roulette, or 0 to trace every path
+		// to the max depth, and the throughput below which paths become likely to be ended
+		//
+		int roulette_depth = 3;
+		float roulette_threshold = 0.5f;
+
+		// Worker threads, or 0 for every core
+		//
+		int threads = 0;
+
+		// Tile size in pixels
+		//
+		int tile_size = 16;
+
+		// Write batch renders to the .pfm output tile by tile as they finish instead of
+		// holding the whole frame in memory
+		//
+		bool stream = false;
+
+		// Denoise batch renders before saving them, guided by the albedo, normal and depth AOVs
+		//
+		bool denoise = false;
+
+		// Reference image (.tga) to compare batch renders against
+		//
+		const char* reference = nullptr;
+
+		// Range of samples to render for each pixel, [first_sample, last_sample). A last sample
+		// of 0 renders all of them.
+		//
+		int first_sample = 0;
+		int last_sample = 0;
+
+		// Regions of the frame to render, or none to render all of it
+		//
+		Tile regions[max_region_count];
+		int region_count = 0;
+
+		// Earlier render (.pfm) to render the regions over
+		//
+		const char* base = nullptr;
+
+		// Wall clock time in seconds for batch renders to refine the image in, or 0 to render
+		// every sample for the quality
+		//
+		float budget = 0;
+
+		// Checkpoint file for batch renders, saved every checkpoint interval (in seconds)
+		//
+		const char* checkpoint = nullptr;
+		int checkpoint_interval = 60;
+
+		// Continue a batch render from the checkpoint
+		//
+		bool resume = false;
+
+		// Accumulation files to merge into the output instead of rendering
+		//
+		const char* merge[max_merge_count] = {};
+		int merge_count = 0;
+
+		// Coordinator and worker settings
+		//
+		Distributed::Settings distributed;
+
+		// Log the time spent in each stage of rendering
+		//
+		bool profile = false;
+
+		// Chrome trace output path, and how deeply nested the traced scopes can be
+		//
+		const char* trace = nullptr;
+		int trace_depth = 1;
+
+		// Depth of the profiled stages to read hardware counters around, 0 for whole renders
+		// only, or -1 for none
+		//
+		int counter_depth = -1;
+
+		// Benchmark settings, which also set the runs for -allocators and -replay
+		//
+		Benchmark::Settings benchmark;
+
+		// Kernel microbenchmark settings
+		//
+		Kernels::Settings kernels;
+
+		// Compare the pool allocator against the heap instead of rendering
+		//
+		bool allocators = false;
+
+		// Placement of the system heap
+		//
+		SystemAllocator::Settings memory;
+
+		// Path to capture the rays cast while rendering to, and a capture to replay instead of
+		// rendering
+		//
+		const char* capture = nullptr;
+		const char* replay = nullptr;
+
+		// Paths to save the cycles spent on each pixel to, as .pfm values or a .tga heatmap
+		//
+		const char* costs[max_cost_count] = {};
+		int cost_count = 0;
+
+		// AOVs to write alongside a batch render, as a bit for each
+		//
+		uint32_t aov_mask = 0;
+	};
 
 	// Constants
 	//
@@ -46,13 +203,219 @@ namespace
 
 		return true;
 	}
+
+	// Parse the options that aren't specific to a feature
+	//
+	CommandLine::Match ParseOption(Options& options, const char* option, const char* value)
+	{
+		if (CommandLine::Is(option, "-batch"))
+			return CommandLine::Flag(options.batch);
+		if (CommandLine::Is(option, "-resume"))
+			return CommandLine::Flag(options.resume);
+		if (CommandLine::Is(option, "-stream"))
+			return CommandLine::Flag(options.stream);
+		if (CommandLine::Is(option, "-denoise"))
+			return CommandLine::Flag(options.denoise);
+		if (CommandLine::Is(option, "-profile"))
+			return CommandLine::Flag(options.profile);
+		if (CommandLine::Is(option, "-allocators"))
+			return CommandLine::Flag(options.allocators);
+		if (CommandLine::Is(option, "-small-pages"))
+			return CommandLine::Flag(options.memory.huge_pages, false);
+		if (CommandLine::Is(option, "-interleave"))
+			return CommandLine::Flag(options.memory.interleave);
+
+		if (CommandLine::Is(option, "-width"))
+			return CommandLine::Parsed(CommandLine::ParseInt(options.w, value, 1, 32768));
+		if (CommandLine::Is(option, "-height"))
+			return CommandLine::Parsed(CommandLine::ParseInt(options.h, value, 1, 32768));
+		if (CommandLine::Is(option, "-quality"))
+			return CommandLine::Parsed(CommandLine::ParseInt(options.quality, value, 1, 256));
+		if (CommandLine::Is(option, "-depth"))
+			return CommandLine::Parsed(CommandLine::ParseInt(options.max_depth, value, 1, 1024));
+		if (CommandLine::Is(option, "-roulette"))
+			return CommandLine::Parsed(CommandLine::ParseInt(options.roulette_depth, value, 0, 1024));
+		if (CommandLine::Is(option, "-roulette-threshold"))
+			return CommandLine::Parsed(CommandLine::ParseFloat(options.roulette_threshold, value, 0.001f, 1000.0f));
+		if (CommandLine::Is(option, "-threads"))
+			return CommandLine::Parsed(CommandLine::ParseInt(options.threads, value, 1, max_worker_count));
+		if (CommandLine::Is(option, "-output"))
+			return CommandLine::Text(options.output, value);
+		if (CommandLine::Is(option, "-tile"))
+			return CommandLine::Parsed(CommandLine::ParseInt(options.tile_size, value, 1, 16384));
+		if (CommandLine::Is(option, "-trace"))
+			return CommandLine::Text(options.trace, value);
+		if (CommandLine::Is(option, "-trace-depth"))
+			return CommandLine::Parsed(CommandLine::ParseInt(options.trace_depth, value, 1, Profiler::max_scope_depth));
+		if (CommandLine::Is(option, "-counters"))
+			return CommandLine::Parsed(CommandLine::ParseInt(options.counter_depth, value, 0, Profiler::max_scope_depth));
+		if (CommandLine::Is(option, "-capture"))
+			return CommandLine::Text(options.capture, value);
+		if (CommandLine::Is(option, "-replay"))
+			return CommandLine::Text(options.replay, value);
+		if (CommandLine::Is(option, "-reference"))
+			return CommandLine::Text(options.reference, value);
+		if (CommandLine::Is(option, "-aov"))
+			return CommandLine::Parsed(value && ParseAovMask(options.aov_mask, value));
+		if (CommandLine::Is(option, "-cost"))
+		{
+			if (options.cost_count == max_cost_count || !value)
+				return CommandLine::Match::Invalid;
+
+			options.costs[options.cost_count++] = value;
+
+			return CommandLine::Match::Value;
+		}
+		if (CommandLine::Is(option, "-samples"))
+			return CommandLine::Parsed(CommandLine::ParseRange(options.first_sample, options.last_sample, value));
+		if (CommandLine::Is(option, "-crop"))
+		{
+			if (options.region_count == max_region_count || !CommandLine::ParseRegion(options.regions[options.region_count], value))
+				return CommandLine::Match::Invalid;
+
+			++options.region_count;
+
+			return CommandLine::Match::Value;
+		}
+		if (CommandLine::Is(option, "-base"))
+			return CommandLine::Text(options.base, value);
+		if (CommandLine::Is(option, "-budget"))
+			return CommandLine::Parsed(CommandLine::ParseFloat(options.budget, value, 0.001f, 1e6f));
+		if (CommandLine::Is(option, "-checkpoint"))
+			return CommandLine::Text(options.checkpoint, value);
+		if (CommandLine::Is(option, "-checkpoint-interval"))
+			return CommandLine::Parsed(CommandLine::ParseInt(options.checkpoint_interval, value, 1, 86400));
+		if (CommandLine::Is(option, "-merge"))
+		{
+			if (options.merge_count == max_merge_count || !value)
+				return CommandLine::Match::Invalid;
+
+			options.merge[options.merge_count++] = value;
+
+			return CommandLine::Match::Value;
+		}
+
+		return CommandLine::Match::None;
+	}
+
+	// Parse the command line, e.g. -batch -width 1920 -height 1080 -quality 8 -depth 6 -output Render.pfm
+	//
+	// Each option is offered to the general options and then to each feature in turn. The
+	// checks that span features are made once all of them have been parsed.
+	//
+	bool ParseOptions(Options& options, int argc, char** argv)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const char* option = argv[i];
+			const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+			CommandLine::Match match = ParseOption(options, option, value);
+
+			if (match == CommandLine::Match::None)
+				match = Benchmark::ParseOption(options.benchmark, option, value);
+			if (match == CommandLine::Match::None)
+				match = Kernels::ParseOption(options.kernels, option, value);
+			if (match == CommandLine::Match::None)
+				match = Distributed::ParseOption(options.distributed, option, value);
+
+			if (match == CommandLine::Match::None)
+			{
+				LOG_ERROR("Unknown option %s", option);
+				return false;
+			}
+
+			if (match == CommandLine::Match::Invalid)
+			{
+				if (value)
+					LOG_ERROR("Bad value '%s' for option %s", value, option);
+				else
+					LOG_ERROR("Missing value for option %s", option);
+
+				return false;
+			}
+
+			if (match == CommandLine::Match::Value)
+				++i;
+		}
+
+		if (options.distributed.local_workers > 0 && options.distributed.coordinator_port == 0)
+		{
+			LOG_ERROR("-workers needs -coordinator");
+			return false;
+		}
+
+		if (options.resume && !options.checkpoint)
+		{
+			LOG_ERROR("-resume needs -checkpoint");
+			return false;
+		}
+
+		if (options.budget > 0 && (options.checkpoint || options.last_sample > 0))
+		{
+			LOG_ERROR("-budget picks its own sample ranges, so it can't be combined with -checkpoint or -samples");
+			return false;
+		}
+
+		if (options.region_count > 0 && (options.checkpoint || options.budget > 0))
+		{
+			LOG_ERROR("-crop can't be combined with -checkpoint or -budget");
+			return false;
+		}
+
+		if (options.stream && (options.region_count > 0 || options.checkpoint || options.budget > 0 || options.base))
+		{
+			LOG_ERROR("-stream writes each tile once, so it can't be combined with -crop, -base, -checkpoint or -budget");
+			return false;
+		}
+
+		if (options.kernels.baseline && !options.kernels.path)
+		{
+			LOG_ERROR("-baseline needs -kernels");
+			return false;
+		}
+
+		if (options.capture && options.replay)
+		{
+			LOG_ERROR("-capture can't be combined with -replay");
+			return false;
+		}
+
+		if (options.cost_count > 0 && (!options.batch || options.stream))
+		{
+			LOG_ERROR("-cost needs -batch, and can't be combined with -stream");
+			return false;
+		}
+
+		// The denoiser is guided by AOVs, so it has the same restrictions
+
+		if (options.denoise)
+			options.aov_mask |= (1u << int(Aov::Albedo)) | (1u << int(Aov::Normal)) | (1u << int(Aov::Depth));
+
+		if (options.aov_mask && (!options.batch || options.stream || options.distributed.coordinator_port))
+		{
+			LOG_ERROR("-aov and -denoise need -batch, and can't be combined with -stream or -coordinator");
+			return false;
+		}
+
+		if (options.reference && !options.batch)
+		{
+			LOG_ERROR("-reference needs -batch");
+			return false;
+		}
+
+		return true;
+	}
 };
 
 struct Application
 {
-	Application(int w, int h) :
-		allocator(1_GiB), window("RayTracer", w, h), renderer(quality), camera({ 0.09f, 0.05f, -0.4f }, { 0, 0.1f, -0.1f })
+	Application(const Options& options) :
+		allocator(1_GiB, options.memory), options(options), renderer(options.quality, options.threads), camera({ 0.09f, 0.05f, -0.4f }, { 0, 0.1f, -0.1f }), integrator(options.max_depth, options.roulette_depth, options.roulette_threshold)
 	{
+		Memory::Register("System", allocator);
+		Memory::Register("Temp", Memory::TempAllocator());
+
 		scene.planes.push_back({ { 0, 0, 0 }, { 0, 1, 0 }, Material(wood_normal, wood_color, wood_roughness, zero) });
 
 		scene.spheres.push_back({ { +0.00f, 0.1f, 0.0f }, 0.1f, Material(gold_normal, gold_color, gold_roughness, one) });
@@ -63,122 +426,264 @@ struct Application
 
 		camera.ApplySettings(Lens::FL35mm, FStop::F16, Shutter::SS100, Iso::ISO100);
 
+		renderer.tile_size = options.tile_size;
+		renderer.measure_costs = options.cost_count > 0;
+
+		if (options.aov_mask)
+		{
+			aovs = AovBuffer(allocator, options.w, options.h, options.tile_size, options.aov_mask);
+			renderer.aovs = &aovs;
+		}
+
+		if (options.reference)
+			Tga::LoadImage(reference, allocator, options.reference);
+
 		Autofocus(camera, scene);
 	}
 
-	void Run()
+	~Application()
 	{
-		renderer.Render(window, camera, scene, integrator);
+		Memory::Unregister(Memory::TempAllocator());
+		Memory::Unregister(allocator);
+	}
 
-		while (window.Update())
-		{
-			Message message;
+	ToneMap::Settings GetToneMap() const
+	{
+		return { camera.exposure, ToneMap::Curve::Aces };
+	}
 
-			while (window.ReadMessage(message))
-			{
-				switch (message.type)
-				{
-					case Message::Type::KeyDown:
-						if (message.data == 'S' && Input::KeyDown(0x11))
-							SaveImage();
-						if (message.data == 'O' && Input::KeyDown(0x11))
-							LoadReferenceImage();
-						if (message.data == 'E')
-							CalculateError();
-						if (message.data == 'R')
-							renderer.Render(window, camera, scene, integrator);
-						break;
-
-					default:
-						break;
-				}
-			}
+	bool RunBatch()
+	{
+		if (options.budget > 0)
+			return RunBudget();
+
+		if (options.stream)
+			return RunStreaming();
 
-			Thread::Sleep(100);
+		renderer.first_sample = options.first_sample;
+		renderer.last_sample = options.last_sample;
+
+		// Sample ranges meant to be merged later are saved as the raw sums
+
+		const char* extension = strrchr(options.output, '.');
+
+		if (extension && String::CompareNoCase(extension, ".acc") == 0)
+		{
+			AccumulationTarget target(allocator, options.w, options.h, options.first_sample, options.last_sample);
+
+			return Render(target) && target.Save(options.output);
 		}
+
+		FramebufferTarget target(allocator, options.w, options.h);
+
+		// Regions are rendered over an earlier render of the whole frame if there is one
+
+		if (options.base && !target.Load(options.base, GetToneMap()))
+			return false;
+
+		return Render(target) && Finish(target);
 	}
 
-	void SaveImage() const
+	bool RunBenchmark()
 	{
-		char path[max_path_length] = { 0 };
+		const Material materials[] =
+		{
+			Material(wood_normal, wood_color, wood_roughness, zero),
+			Material(gold_normal, gold_color, gold_roughness, one),
+			Material(steel_normal, steel_color, steel_roughness, one),
+			Material(tile_normal, tile_color, tile_roughness, zero),
+		};
 
-		if (!Dialog::GetSaveFilename(path, sizeof(path), ".", "Targa (*.tga)\0*.tga\0"))
-			return;
+		Benchmark::Settings settings = options.benchmark;
 
-		const Image<Bgra> buffer(Memory::TempAllocator(), window.w, window.h);
+		settings.threads = options.threads;
 
-		if (!window.Capture(buffer.texels, buffer.w, buffer.h))
-			return;
+		return Benchmark::Run(allocator, settings, materials, countof(materials));
+	}
 
-		Tga::SaveImage(path, buffer);
+	bool RunKernels()
+	{
+		return Kernels::Run(scene, camera, options.kernels);
 	}
 
-	void LoadReferenceImage()
+	bool RunStreaming()
 	{
-		char path[max_path_length] = { 0 };
+		const char* extension = strrchr(options.output, '.');
 
-		if (!Dialog::GetOpenFilename(path, sizeof(path), ".", "Targa (*.tga)\0*.tga\0"))
-			return;
+		if (!extension || String::CompareNoCase(extension, ".pfm") != 0)
+		{
+			LOG_ERROR("Streamed renders can only be saved as .pfm");
+			return false;
+		}
+
+		renderer.first_sample = options.first_sample;
+		renderer.last_sample = options.last_sample;
+
+		// Two blocks per worker lets each keep rendering while its last tile is written
+
+		StreamingTarget target(allocator, options.w, options.h, renderer.tile_size, 2 * renderer.scheduler.worker_count, camera.exposure);
 
-		Tga::LoadImage(reference, allocator, path);
+		if (!target.Open(options.output))
+			return false;
+
+		// Rendering rows of tiles in order keeps the writes close together in the file
+
+		renderer.Start(target, camera, scene, integrator, RowPriority());
+		renderer.Wait();
+
+		return target.Close();
 	}
 
-	void CalculateError() const
+	bool RunBudget()
 	{
-		if (!reference.texels)
+		// Refine the image for as long as the budget allows, with the quality setting the max
+		// sample count
+
+		AccumulationTarget samples(allocator, options.w, options.h, 0, 0);
+
+		Progressive::Render(renderer, samples, camera, scene, integrator, options.budget);
+
+		FramebufferTarget target(allocator, options.w, options.h);
+
+		samples.Resolve(target);
+
+		return Finish(target);
+	}
+
+	// Compare a finished batch render with the reference, denoise it if asked to, and save it
+	//
+	bool Finish(FramebufferTarget& target)
+	{
+		if (options.reference)
+			target.CalculateError(reference, GetToneMap());
+
+		if (options.denoise)
 		{
-			LOG_ERROR("Can't calculate variance because there is no reference image");
-			return;
+			Denoiser::Settings settings;
+
+			settings.exposure = camera.exposure;
+
+			Denoiser::Run(allocator, target.radiance, aovs, renderer.scheduler, settings);
+
+			if (options.reference)
+				target.CalculateError(reference, GetToneMap());
 		}
 
-		if (reference.w != window.w || reference.h != window.h)
+		return target.Save(options.output, GetToneMap());
+	}
+
+	// Render the frame in the foreground, through a checkpoint if there is one
+	//
+	bool Render(RenderTarget& target)
+	{
+		if (!options.checkpoint)
 		{
-			LOG_ERROR("The reference image has different dimensions to the display image");
-			return;
+			renderer.Render(target, camera, scene, integrator, options.regions, options.region_count);
+			return true;
 		}
 
-		const Image<Bgra> render(Memory::TempAllocator(), window.w, window.h);
+		CheckpointTarget::Setup setup;
+		setup.tile_size = renderer.tile_size;
+		setup.quality = options.quality;
+		setup.first_sample = options.first_sample;
+		setup.last_sample = options.last_sample;
+
+		CheckpointTarget checkpoint(allocator, target, setup, options.checkpoint);
+
+		if (options.resume && !checkpoint.Resume())
+			return false;
+
+		checkpoint.Start(float(options.checkpoint_interval));
+
+		renderer.Render(checkpoint, camera, scene, integrator);
+
+		checkpoint.Stop();
+
+		return true;
+	}
+
+	bool RunMerge()
+	{
+		Array<AccumulationTarget> parts(allocator, options.merge_count);
+		Array<AccumulationTarget*> order(allocator, options.merge_count);
 
-		if (!window.Capture(render.texels, render.w, render.h))
+		for (int i = 0; i < options.merge_count; ++i)
 		{
-			LOG_ERROR("Failed to capture the window");
-			return;
+			if (!parts[i].Load(allocator, options.merge[i]))
+				return false;
+
+			order[i] = &parts[i];
 		}
 
-		float squared_error_sum = 0;
-		float value_sum = 0;
+		// Merge in sample order whatever order the files were given in, so that the sums are
+		// always added up the same way
 
-		const int count = reference.w * reference.h;
+		std::sort(order.values, order.values + order.count, [](const AccumulationTarget* a, const AccumulationTarget* b) { return a->first_sample < b->first_sample; });
 
-		for (int i = 0; i < count; ++i)
-		{
-			const float3 cref = reference[i].ToLinear();
-			const float3 cdis = render[i].ToLinear();
+		AccumulationTarget& merged = *order[0];
 
-			squared_error_sum += Square(CalculateLuminance(cdis - cref));
-			value_sum += CalculateLuminance(cref);
+		for (int i = 1; i < order.count; ++i)
+		{
+			if (!merged.Merge(*order[i]))
+				return false;
 		}
 
-		const float mean = value_sum / count;
+		LOG_INFO("Merged samples [%i, %i) from %i files", merged.first_sample, merged.last_sample, order.count);
+
+		FramebufferTarget target(allocator, merged.GetWidth(), merged.GetHeight());
 
-		const float mse = squared_error_sum / count;
-		const float rms = Sqrt(mse) / mean;
+		merged.Resolve(target);
 
-		LOG_INFO("MSE: %.6f, RMS: %.2f %%", mse, rms * 100);
+		return target.Save(options.output, GetToneMap());
+	}
+
+	bool RunCoordinator()
+	{
+		FramebufferTarget target(allocator, options.w, options.h);
+
+		Distributed::Setup setup;
+		setup.w = options.w;
+		setup.h = options.h;
+		setup.quality = options.quality;
+		setup.max_depth = options.max_depth;
+		setup.roulette_depth = options.roulette_depth;
+		setup.roulette_threshold = options.roulette_threshold;
+		setup.tile_size = renderer.tile_size;
+
+		if (!Distributed::RunCoordinator(allocator, target, setup, options.distributed, options.threads))
+			return false;
+
+		return target.Save(options.output, GetToneMap());
+	}
+
+	bool RunWorker(Distributed::Worker& worker)
+	{
+		return worker.Serve(renderer, camera, scene, integrator);
+	}
+
+	bool RunInteractive()
+	{
+		Viewer viewer(allocator, renderer, camera, scene, integrator);
+
+		return viewer.Run(options.w, options.h);
 	}
 
 	// System heap
 	//
 	SystemAllocator allocator;
 
-	// Native window
+	// Command line options
 	//
-	Window window;
+	Options options;
 
 	// Renderer
 	//
 	Renderer renderer;
 
+	// AOVs written during batch renders
+	//
+	AovBuffer aovs;
+
 	// Camera
 	//
 	Camera camera;
@@ -189,7 +694,7 @@ struct Application
 
 	// Integrator
 	//
-	PathIntegrator integrator = { max_depth };
+	PathIntegrator integrator;
 	//DirectIntegrator integrator;
 	//DepthIntegrator integrator;
 
@@ -213,26 +718,104 @@ struct Application
 	ImageTexture<LinearValue> steel_roughness = { allocator, "SteelRoughness.tga" };
 };
 
-void Run(int w, int h)
+bool Run(Application& application, const Options& options)
 {
-	Application application(w, h);
+	if (options.benchmark.path)
+		return application.RunBenchmark();
+
+	if (options.kernels.path)
+		return application.RunKernels();
+
+	if (options.allocators)
+		return AllocatorBenchmark::Run(application.allocator, options.threads, options.benchmark.runs);
+
+	if (options.replay)
+		return RayCapture::Replay(options.replay, application.scene, options.benchmark.runs);
+
+	if (options.merge_count > 0)
+		return application.RunMerge();
+
+	if (options.distributed.coordinator_port)
+		return application.RunCoordinator();
+
+	return options.batch ? application.RunBatch() : application.RunInteractive();
+}
+
+bool Run(const Options& options)
+{
+	Application application(options);
+
+	const bool profile = options.profile || options.trace || options.counter_depth >= 0;
+
+	if (profile)
+		Profiler::Enable(application.allocator, options.trace ? options.trace_depth : 0, options.trace ? trace_event_capacity : 0, options.counter_depth);
+
+	if (options.capture && !RayCapture::Start(application.allocator, options.capture, application.scene))
+		return false;
+
+	bool success = Run(application, options);
+
+	if (options.capture)
+		success &= RayCapture::Stop();
+
+	if (success && options.aov_mask)
+		success &= application.aovs.Save(options.output, application.camera.exposure);
+
+	if (success && options.cost_count > 0)
+	{
+		CostMap::Log(application.renderer.costs, application.renderer.tile_size);
+
+		for (int i = 0; i < options.cost_count; ++i)
+			success &= CostMap::Save(options.costs[i], application.renderer.costs);
+	}
+
+	if (options.trace)
+		success &= Profiler::SaveTrace(options.trace);
+
+	if (profile)
+		Profiler::Disable();
+
+	return success;
+}
+
+// Render tiles for a coordinator using the render settings it sends
+//
+bool RunWorker(Options options)
+{
+	Distributed::Worker worker;
+	Distributed::Setup setup;
+
+	if (!worker.Connect(options.distributed.worker, setup))
+		return false;
+
+	options.w = setup.w;
+	options.h = setup.h;
+	options.quality = setup.quality;
+	options.max_depth = setup.max_depth;
+	options.roulette_depth = setup.roulette_depth;
+	options.roulette_threshold = setup.roulette_threshold;
+
+	Application application(options);
+
+	application.renderer.tile_size = setup.tile_size;
+	application.renderer.scheduler.processor_offset = options.distributed.processor_offset;
 
-	application.Run();
+	return application.RunWorker(worker);
 }
 
 int main(int argc, char** argv)
 {
-	if (argc == 2 && _stricmp(argv[1], "-unittest") == 0)
+	if (argc == 2 && String::CompareNoCase(argv[1], "-unittest") == 0)
 		return UnitTest::RunTests();
 
 	if (!Log::Initialize(Severity::Info))
 		return 1;
 
-	const int downsize = 2;
+	Options options;
 
-	Run(1536 / downsize, 1024 / downsize);
+	const bool success = ParseOptions(options, argc, argv) && (options.distributed.worker ? RunWorker(options) : Run(options));
 
 	Log::Shutdown();
 
-	return 0;
+	return success ? 0 : 1;
 }
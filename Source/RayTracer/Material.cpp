@@ -1,10 +1,13 @@
 #include <RayTracer/Material.h>
 #include <RayTracer/Brdf/UberBrdf.h>
 #include <RayTracer/Intersection.h>
+#include <RayTracer/Profiler.h>
 #include <Core/Generic.h>
 
 UberBrdf Material::CreateBrdf(float2 uv, float3x3 world_from_surface) const
 {
+	PROFILE_SCOPE(Material);
+
 	const float metal = metalness->Sample(uv);
 	
 	const float3 kx = color->Sample(uv);
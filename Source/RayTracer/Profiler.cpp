@@ -0,0 +1,419 @@
+#include <RayTracer/Profiler.h>
+#include <System/File.h>
+#include <System/Time.h>
+#include <Core/Allocator.h>
+#include <Core/Assert.h>
+#include <Core/Memory.h>
+#include <Core/Writer.h>
+#include <Core/String.h>
+#include <Core/Log.h>
+
+namespace
+{
+	constexpr const char* stage_names[Profiler::stage_count] =
+	{
+		"Task",
+		"Intersect",
+		"Shadow",
+		"Environment",
+		"Brdf",
+		"Material",
+	};
+
+	bool enabled = false;
+
+	Allocator* allocator = nullptr;
+
+	int trace_depth = 0;
+	int event_capacity = 0;
+
+	// Depth of the scopes to read hardware counters around, or -1 for none at all
+	//
+	int counter_depth = -1;
+
+	// Cycle counter and time when profiling started, used to convert cycles to time
+	//
+	uint64_t base_cycles = 0;
+	uint64_t base_time = 0;
+
+	int worker_count = 0;
+
+	Profiler::ThreadProfile workers[max_worker_count];
+
+	// Totals over all workers for the last render
+	//
+	Profiler::Node totals[Profiler::stage_count + 1][Profiler::stage_count];
+
+	uint64_t render_counts[PerfCounters::counter_count];
+
+	// Counters that every worker of the last render could open
+	//
+	bool available[PerfCounters::counter_count];
+
+	// Format the available counts along with the rates derived from them
+	//
+	void FormatCounts(char* buffer, size_t size, const uint64_t* counts)
+	{
+		using Counter = PerfCounters::Counter;
+
+		const double cycles = double(counts[int(Counter::Cycles)]);
+		const double instructions = double(counts[int(Counter::Instructions)]);
+
+		size_t length = 0;
+
+		buffer[0] = 0;
+
+		for (int i = 0; i < PerfCounters::counter_count; ++i)
+		{
+			if (!available[i])
+				continue;
+
+			const Counter counter = Counter(i);
+
+			length += String::Format(buffer + length, size - length, "%s%s = %llu", length > 0 ? ", " : "", PerfCounters::GetName(counter), counts[i]);
+
+			if (counter == Counter::Instructions && available[int(Counter::Cycles)] && cycles > 0)
+				length += String::Format(buffer + length, size - length, " (IPC %.2f)", instructions / cycles);
+			else if ((counter == Counter::CacheMisses || counter == Counter::BranchMisses) && available[int(Counter::Instructions)] && instructions > 0)
+				length += String::Format(buffer + length, size - length, " (%.2f per kinstr)", 1000 * counts[i] / instructions);
+			else if (counter == Counter::BackendStalls && available[int(Counter::Cycles)] && cycles > 0)
+				length += String::Format(buffer + length, size - length, " (%.1f%% of cycles)", 100 * counts[i] / cycles);
+		}
+	}
+
+	double GetCyclesPerSecond()
+	{
+		const float elapsed = Time::Elapsed(base_time, Time::Now());
+
+		return elapsed > 0 ? double(Profiler::ReadCycles() - base_cycles) / elapsed : 1.0;
+	}
+
+	void LogNode(int parent, int depth, double seconds_per_cycle, uint64_t root_total)
+	{
+		for (int i = 0; i < Profiler::stage_count; ++i)
+		{
+			const Profiler::Node& node = totals[parent][i];
+
+			if (node.calls == 0)
+				continue;
+
+			LOG_INFO("  %*s%-*s calls = %12llu, total = %10.1f ms (%5.1f%%), self = %10.1f ms (%5.1f%%)", 2 * depth, "", 16 - 2 * depth, stage_names[i], node.calls, node.total * seconds_per_cycle * 1000, 100.0 * node.total / root_total, node.self * seconds_per_cycle * 1000, 100.0 * node.self / root_total);
+
+			if (depth < counter_depth)
+			{
+				char counts[512];
+
+				FormatCounts(counts, sizeof(counts), node.counts);
+
+				if (counts[0])
+					LOG_INFO("  %*s%s", 2 * depth + 17, "", counts);
+			}
+
+			if (depth + 1 < Profiler::max_scope_depth)
+				LogNode(i, depth + 1, seconds_per_cycle, root_total);
+		}
+	}
+}
+
+thread_local Profiler::ThreadProfile* Profiler::Current = nullptr;
+
+void Profiler::ThreadProfile::Begin(Stage stage, uint64_t now)
+{
+	ASSERT(depth < max_scope_depth, "Profile scopes are nested too deeply");
+
+	Frame& frame = stack[depth++];
+
+	frame.stage = stage;
+	frame.begin = now;
+	frame.children = 0;
+
+	if (counting && depth <= counter_depth)
+		counters.Read(frame.counts);
+}
+
+void Profiler::ThreadProfile::End(uint64_t now)
+{
+	ASSERT(depth > 0, "Profile scope ended without beginning");
+
+	const Frame& frame = stack[--depth];
+
+	const uint64_t elapsed = now - frame.begin;
+
+	const int parent = depth > 0 ? int(stack[depth - 1].stage) : stage_count;
+
+	Node& node = nodes[parent][int(frame.stage)];
+
+	node.calls++;
+	node.total += elapsed;
+	node.self += elapsed - frame.children;
+
+	if (depth > 0)
+		stack[depth - 1].children += elapsed;
+
+	if (counting && depth < counter_depth)
+	{
+		uint64_t counts[PerfCounters::counter_count];
+
+		counters.Read(counts);
+
+		for (int i = 0; i < PerfCounters::counter_count; ++i)
+			node.counts[i] += counts[i] - frame.counts[i];
+	}
+
+	if (depth >= trace_depth)
+		return;
+
+	if (event_count == event_capacity)
+	{
+		++dropped;
+		return;
+	}
+
+	Event& event = events[event_count++];
+
+	event.begin = frame.begin;
+	event.end = now;
+	event.stage = frame.stage;
+}
+
+void Profiler::Enable(Allocator& allocator_, int trace_depth_, int event_capacity_, int counter_depth_)
+{
+#ifdef FINAL_BUILD
+	LOG_WARNING("Profiling is compiled out of final builds");
+#endif
+
+	enabled = true;
+	allocator = &allocator_;
+	trace_depth = trace_depth_;
+	event_capacity = event_capacity_;
+	counter_depth = counter_depth_;
+
+	base_cycles = ReadCycles();
+	base_time = Time::Now();
+}
+
+void Profiler::Disable()
+{
+	for (ThreadProfile& profile : workers)
+	{
+		if (profile.events)
+			allocator->DeleteArray(profile.events, event_capacity);
+
+		profile.events = nullptr;
+		profile.event_count = 0;
+		profile.dropped = 0;
+	}
+
+	enabled = false;
+}
+
+bool Profiler::IsEnabled()
+{
+	return enabled;
+}
+
+void Profiler::OnStartRender(int workers_)
+{
+	if (!enabled)
+		return;
+
+	worker_count = workers_;
+
+	// Trace buffers are allocated here rather than on the workers since the allocator isn't
+	// thread safe
+
+	Memory::TagScope tag(Memory::Tag::Profiling);
+
+	for (int i = 0; i < worker_count; ++i)
+	{
+		ThreadProfile& profile = workers[i];
+
+		for (auto& row : profile.nodes)
+		{
+			for (Node& node : row)
+				node = Node();
+		}
+
+		if (!profile.events && event_capacity > 0)
+			profile.events = allocator->NewArray<Event>(event_capacity);
+	}
+}
+
+void Profiler::OnFinishRender()
+{
+	if (!enabled)
+		return;
+
+	for (int p = 0; p <= stage_count; ++p)
+	{
+		for (int i = 0; i < stage_count; ++i)
+		{
+			Node total;
+
+			for (int w = 0; w < worker_count; ++w)
+			{
+				const Node& node = workers[w].nodes[p][i];
+
+				total.calls += node.calls;
+				total.total += node.total;
+				total.self += node.self;
+
+				for (int c = 0; c < PerfCounters::counter_count; ++c)
+					total.counts[c] += node.counts[c];
+			}
+
+			totals[p][i] = total;
+		}
+	}
+
+	// Counts are only reported if every worker has them, since partial sums would mislead
+
+	for (int i = 0; i < PerfCounters::counter_count; ++i)
+	{
+		render_counts[i] = 0;
+		available[i] = counter_depth >= 0 && worker_count > 0;
+
+		for (int w = 0; w < worker_count; ++w)
+		{
+			render_counts[i] += workers[w].render_counts[i];
+			available[i] &= workers[w].available[i];
+		}
+	}
+}
+
+void Profiler::OnStartWorker(int worker)
+{
+	if (!enabled)
+		return;
+
+	Current = &workers[worker];
+	Current->depth = 0;
+
+	// Count everything the worker does for the render, not just the profiled scopes
+
+	if (counter_depth >= 0)
+	{
+		Current->counting = Current->counters.Open();
+		Current->counters.Read(Current->render_counts);
+	}
+}
+
+void Profiler::OnFinishWorker(int worker)
+{
+	if (!enabled)
+		return;
+
+	ThreadProfile& profile = workers[worker];
+
+	ASSERT(profile.depth == 0, "Worker finished with profile scopes still open");
+
+	if (profile.counting)
+	{
+		uint64_t counts[PerfCounters::counter_count];
+
+		profile.counters.Read(counts);
+
+		for (int i = 0; i < PerfCounters::counter_count; ++i)
+			profile.render_counts[i] = counts[i] - profile.render_counts[i];
+	}
+
+	// Keep which counters were available, since they're closed here on their own thread
+
+	for (int i = 0; i < PerfCounters::counter_count; ++i)
+		profile.available[i] = profile.counting && profile.counters.IsAvailable(PerfCounters::Counter(i));
+
+	profile.counters.Close();
+	profile.counting = false;
+
+	Current = nullptr;
+}
+
+void Profiler::Log()
+{
+	if (!enabled)
+		return;
+
+	if (counter_depth >= 0)
+	{
+		char counts[512];
+
+		FormatCounts(counts, sizeof(counts), render_counts);
+
+		if (counts[0])
+			LOG_INFO("Counters: %s", counts);
+		else
+			LOG_WARNING("Hardware counters aren't available on this machine");
+	}
+
+	uint64_t root_total = 0;
+
+	for (const Node& node : totals[stage_count])
+		root_total += node.total;
+
+	if (root_total == 0)
+		return;
+
+	const double seconds_per_cycle = 1.0 / GetCyclesPerSecond();
+
+	LOG_INFO("Profile (summed over %i workers):", worker_count);
+
+	LogNode(stage_count, 0, seconds_per_cycle, root_total);
+}
+
+bool Profiler::SaveTrace(const char* path)
+{
+	int count = 0;
+	int dropped = 0;
+
+	for (const ThreadProfile& profile : workers)
+	{
+		count += profile.event_count;
+		dropped += profile.dropped;
+	}
+
+	// Each event is well under 128 characters
+
+	File file;
+
+	if (!file.OpenForWrite(path, 128 * size_t(count) + 1_KiB))
+	{
+		LOG_ERROR("Failed to save trace to %s", path);
+		return false;
+	}
+
+	Writer writer(file.contents, file.size);
+
+	writer.WriteString("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	const double us_per_cycle = 1000000.0 / GetCyclesPerSecond();
+
+	bool first = true;
+
+	for (int w = 0; w < max_worker_count; ++w)
+	{
+		const ThreadProfile& profile = workers[w];
+
+		for (int i = 0; i < profile.event_count; ++i)
+		{
+			const Event& event = profile.events[i];
+
+			const double ts = double(int64_t(event.begin - base_cycles)) * us_per_cycle;
+			const double dur = double(event.end - event.begin) * us_per_cycle;
+
+			writer.WriteString("%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%i,\"ts\":%.3f,\"dur\":%.3f}", first ? "" : ",\n", stage_names[int(event.stage)], w, ts, dur);
+
+			first = false;
+		}
+	}
+
+	writer.WriteString("\n]}\n");
+
+	file.Close(writer.BytesWritten());
+
+	if (dropped > 0)
+		LOG_WARNING("Dropped %i trace events after the buffers filled up", dropped);
+
+	LOG_INFO("Saved %i trace events to %s", count, path);
+
+	return true;
+}
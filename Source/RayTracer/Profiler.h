@@ -0,0 +1,196 @@
+#pragma once
+
+#include <System/PerfCounters.h>
+#include <Core/Constants.h>
+#include <Core/Types.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <System/Time.h>
+#endif
+
+struct Allocator;
+
+// Scoped cycle counters around the main stages of rendering. Each worker keeps its own call
+// counts and cycle totals for every stage under every parent stage, so nothing is shared
+// while rendering, and the totals are summed when the render finishes. Scopes down to a
+// chosen depth are also recorded as events for a Chrome trace (chrome://tracing).
+// Hardware counters can also be read around each render and around the scopes down to a
+// chosen depth, although reading them costs a system call.
+//
+namespace Profiler
+{
+	enum class Stage : uint8_t
+	{
+		Task,
+		Intersect,
+		Shadow,
+		Environment,
+		Brdf,
+		Material,
+		Count
+	};
+
+	constexpr int stage_count = int(Stage::Count);
+
+	// Deepest nesting of scopes
+	//
+	constexpr int max_scope_depth = 16;
+
+	struct Node
+	{
+		// Number of times the stage ran under its parent
+		//
+		uint64_t calls = 0;
+
+		// Cycles spent in the stage including and excluding the stages inside it
+		//
+		uint64_t total = 0;
+		uint64_t self = 0;
+
+		// Hardware counts for the stage including the stages inside it
+		//
+		uint64_t counts[PerfCounters::counter_count] = {};
+	};
+
+	struct Event
+	{
+		// Cycle counts at the start and end of the scope
+		//
+		uint64_t begin = 0;
+		uint64_t end = 0;
+
+		// Stage of the scope
+		//
+		Stage stage = Stage::Task;
+	};
+
+	struct Frame
+	{
+		// Stage of the open scope and the cycle count when it began
+		//
+		Stage stage = Stage::Task;
+		uint64_t begin = 0;
+
+		// Cycles spent in the scopes inside it so far
+		//
+		uint64_t children = 0;
+
+		// Hardware counts when it began
+		//
+		uint64_t counts[PerfCounters::counter_count] = {};
+	};
+
+	struct ThreadProfile
+	{
+		// Totals for each stage under each parent, with the last row for top level scopes
+		//
+		Node nodes[stage_count + 1][stage_count];
+
+		// Scopes currently open
+		//
+		Frame stack[max_scope_depth];
+		int depth = 0;
+
+		// Trace events, kept across renders until the trace is saved
+		//
+		Event* events = nullptr;
+		int event_count = 0;
+		int dropped = 0;
+
+		// Hardware counters for the thread, the counts over the whole render, and which
+		// counters could be opened for it
+		//
+		PerfCounters counters;
+		bool counting = false;
+		uint64_t render_counts[PerfCounters::counter_count] = {};
+		bool available[PerfCounters::counter_count] = {};
+
+		void Begin(Stage stage, uint64_t now);
+		void End(uint64_t now);
+	};
+
+	// Start profiling the workers of later renders. Scopes nested at most trace_depth deep are
+	// also kept for the trace, up to event_capacity for each worker. Hardware counters are
+	// read around each render if counter_depth is 0 or more, and also around the scopes
+	// nested at most counter_depth deep.
+	//
+	void Enable(Allocator& allocator, int trace_depth, int event_capacity, int counter_depth = -1);
+
+	// Stop profiling and free the trace events
+	//
+	void Disable();
+
+	// Return true if profiling has been enabled
+	//
+	bool IsEnabled();
+
+	// Notify that a render will start with the given number of workers
+	//
+	void OnStartRender(int workers);
+
+	// Notify that a render has completed, summing the totals from all workers
+	//
+	void OnFinishRender();
+
+	// Notify that a worker thread is starting or has run out of work
+	//
+	void OnStartWorker(int worker);
+	void OnFinishWorker(int worker);
+
+	// Log the totals for the last render as a tree of stages
+	//
+	void Log();
+
+	// Save the recorded events as Chrome trace event JSON
+	//
+	bool SaveTrace(const char* path);
+
+	// Profile of the current thread, or null if it isn't being profiled
+	//
+	extern thread_local ThreadProfile* Current;
+
+	inline uint64_t ReadCycles()
+	{
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#else
+		return Time::Now();
+#endif
+	}
+
+	struct Scope
+	{
+		Scope(Stage stage) : profile(Current)
+		{
+			if (profile)
+				profile->Begin(stage, ReadCycles());
+		}
+
+		Scope(const Scope&) = delete;
+		void operator=(const Scope&) = delete;
+
+		~Scope()
+		{
+			if (profile)
+				profile->End(ReadCycles());
+		}
+
+		// Profile the scope was opened on
+		//
+		ThreadProfile* profile;
+	};
+}
+
+// Profile the rest of the enclosing block as the given stage. Compiled out of final builds.
+//
+#ifndef FINAL_BUILD
+#define PROFILE_SCOPE_JOIN2(A__, B__) A__##B__
+#define PROFILE_SCOPE_JOIN(A__, B__) PROFILE_SCOPE_JOIN2(A__, B__)
+#define PROFILE_SCOPE(STAGE__) Profiler::Scope PROFILE_SCOPE_JOIN(profile_scope_, __LINE__)(Profiler::Stage::STAGE__)
+#else
+#define PROFILE_SCOPE(STAGE__)
+#endif
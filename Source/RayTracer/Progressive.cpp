@@ -0,0 +1,97 @@
+#include <RayTracer/Progressive.h>
+#include <RayTracer/Accumulation.h>
+#include <RayTracer/Renderer.h>
+#include <RayTracer/Stats.h>
+#include <System/Thread.h>
+#include <System/Time.h>
+#include <Core/Generic.h>
+#include <Core/Log.h>
+#include <cmath>
+
+Progressive::Result Progressive::Render(Renderer& renderer, AccumulationTarget& target, const Camera& camera, const Scene& scene, const Integrator& integrator, float budget)
+{
+	const uint64_t start = Time::Now();
+
+	const int w = target.GetWidth();
+	const int h = target.GetHeight();
+
+	const int max_samples = renderer.quality * renderer.quality;
+
+	Result result;
+
+	// Seconds to take one sample for every pixel, measured after each pass
+
+	double sample_time = 0;
+
+	int samples = 0;
+	int pass_samples = 1;
+
+	while (samples < max_samples)
+	{
+		const float remaining = budget - Time::Elapsed(start, Time::Now());
+
+		// Double the samples each pass, but only take as many as are expected to fit in the
+		// time left
+
+		int count = Min(pass_samples, max_samples - samples);
+
+		if (sample_time > 0)
+			count = Min(count, int(remaining / sample_time));
+
+		if (count <= 0 || remaining <= 0)
+			break;
+
+		renderer.first_sample = samples;
+		renderer.last_sample = samples + count;
+
+		renderer.Start(target, camera, scene, integrator, CenterPriority(w, h));
+
+		++result.passes;
+
+		while (renderer.IsRunning())
+		{
+			if (Time::Elapsed(start, Time::Now()) >= budget)
+				renderer.Cancel();
+
+			Thread::Sleep(10);
+		}
+
+		if (!renderer.Wait())
+			break;
+
+		samples += count;
+		pass_samples = samples;
+
+		// Estimate the cost of the next pass from the measured Mray/s and the rays each sample
+		// needed in this one
+
+		const double rays_per_sample = double(Stats::TotalRays) / (double(count) * w * h);
+
+		sample_time = rays_per_sample * w * h / Stats::GetRaysPerSecond();
+
+		// The relative error of the pass falls with the square root of the sample count
+
+		float error_sum = 0;
+
+		for (int i = 0; i < renderer.errors.w * renderer.errors.h; ++i)
+			error_sum += renderer.errors[i];
+
+		result.error = error_sum / (renderer.errors.w * renderer.errors.h) * sqrtf(float(count) / samples);
+
+		LOG_INFO("Pass %i: samples = %i, estimated error = %.2f %%, %.2f s per sample, %.2f s left", result.passes, samples, result.error * 100, sample_time, budget - Time::Elapsed(start, Time::Now()));
+	}
+
+	// Tiles finished by a cancelled pass have more samples than the rest, so count them all
+
+	double sample_sum = 0;
+
+	for (int i = 0; i < w * h; ++i)
+		sample_sum += target.sums[i].count;
+
+	result.samples = float(sample_sum / (w * h));
+
+	LOG_INFO("Budget render: budget = %.2f s, duration = %.2f s, passes = %i, samples per pixel = %.2f, estimated error = %.2f %%",
+		budget, Time::Elapsed(start, Time::Now()), result.passes, result.samples, result.error * 100);
+
+	return result;
+}
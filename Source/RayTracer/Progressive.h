@@ -0,0 +1,32 @@
+#pragma once
+
+struct Renderer;
+struct AccumulationTarget;
+struct Camera;
+struct Scene;
+struct Integrator;
+
+namespace Progressive
+{
+	struct Result
+	{
+		// Number of passes started, including one cut short by the deadline
+		//
+		int passes = 0;
+
+		// Mean samples per pixel reached
+		//
+		float samples = 0;
+
+		// Estimated mean relative error of the image
+		//
+		float error = 0;
+	};
+
+	// Render passes over increasing sample ranges into the target until the time budget (in
+	// seconds) runs out or every sample for the renderer quality has been taken. Each pass is
+	// sized from the measured ray throughput so that it fits in the time left, and a pass still
+	// running at the deadline is cancelled, keeping the tiles it finished.
+	//
+	Result Render(Renderer& renderer, AccumulationTarget& target, const Camera& camera, const Scene& scene, const Integrator& integrator, float budget);
+}
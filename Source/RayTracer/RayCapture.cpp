@@ -0,0 +1,316 @@
+#include <RayTracer/RayCapture.h>
+#include <RayTracer/Scene.h>
+#include <System/File.h>
+#include <System/Mutex.h>
+#include <System/Time.h>
+#include <Core/Allocator.h>
+#include <Core/Generic.h>
+#include <Core/Memory.h>
+#include <Core/Log.h>
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	// Relative difference in hit distance that still counts as the same hit
+	//
+	constexpr float distance_tolerance = 0.0001f;
+
+	// Mismatches that are logged individually
+	//
+	constexpr int max_logged_mismatches = 8;
+
+	Allocator* allocator = nullptr;
+
+	File file;
+
+	// Guards the file and the number of records written to it
+	//
+	Mutex mutex;
+
+	uint64_t written = 0;
+
+	uint64_t scene_hash = 0;
+
+	bool failed = false;
+
+	RayCapture::ThreadCapture workers[max_worker_count];
+
+	void Hash(uint64_t& hash, const void* data, size_t size)
+	{
+		// FNV-1a
+
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+		for (size_t i = 0; i < size; ++i)
+			hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+	}
+
+	// Return true if the replayed result matches the recorded one
+	//
+	bool Matches(const RayCapture::Record& record, bool hit, float t)
+	{
+		if (hit != ((record.flags & RayCapture::Hit) != 0))
+			return false;
+
+		if (!hit || (record.flags & RayCapture::Occlusion))
+			return true;
+
+		return Abs(t - record.t) <= distance_tolerance * Max(1.0f, record.t);
+	}
+}
+
+thread_local RayCapture::ThreadCapture* RayCapture::Current = nullptr;
+
+void RayCapture::ThreadCapture::Flush()
+{
+	if (count == 0)
+		return;
+
+	{
+		ScopedLock lock(mutex);
+
+		if (!file.WriteAt(sizeof(Header) + sizeof(Record) * written, records, sizeof(Record) * count))
+			failed = true;
+
+		written += count;
+	}
+
+	count = 0;
+}
+
+bool RayCapture::Start(Allocator& allocator_, const char* path, const Scene& scene)
+{
+#ifdef FINAL_BUILD
+	LOG_WARNING("Ray capture is compiled out of final builds");
+#endif
+
+	if (!file.OpenForStreaming(path))
+	{
+		LOG_ERROR("Failed to create ray capture %s", path);
+		return false;
+	}
+
+	allocator = &allocator_;
+	written = 0;
+	scene_hash = HashScene(scene);
+	failed = false;
+
+	return true;
+}
+
+bool RayCapture::Stop()
+{
+	if (!allocator)
+		return false;
+
+	for (ThreadCapture& capture : workers)
+	{
+		if (capture.records)
+			allocator->DeleteArray(capture.records, buffer_capacity);
+
+		capture.records = nullptr;
+		capture.count = 0;
+	}
+
+	allocator = nullptr;
+
+	Header header;
+
+	header.count = written;
+	header.scene = scene_hash;
+
+	if (!file.WriteAt(0, &header, sizeof(header)))
+		failed = true;
+
+	file.Close();
+
+	if (failed)
+	{
+		LOG_ERROR("Failed to write the ray capture");
+		return false;
+	}
+
+	LOG_INFO("Captured %llu rays (%.1f MiB)", written, (sizeof(Header) + sizeof(Record) * written) / double(1_MiB));
+
+	return true;
+}
+
+void RayCapture::OnStartRender(int workers_)
+{
+	if (!allocator)
+		return;
+
+	// Buffers are allocated here rather than on the workers since the allocator isn't thread safe
+
+	Memory::TagScope tag(Memory::Tag::Profiling);
+
+	for (int i = 0; i < workers_; ++i)
+	{
+		if (!workers[i].records)
+			workers[i].records = allocator->NewArray<Record>(buffer_capacity);
+	}
+}
+
+void RayCapture::OnStartWorker(int worker)
+{
+	Current = allocator ? &workers[worker] : nullptr;
+}
+
+void RayCapture::OnFinishWorker(int worker)
+{
+	unused(worker);
+
+	if (Current)
+		Current->Flush();
+
+	Current = nullptr;
+}
+
+bool RayCapture::Replay(const char* path, const Scene& scene, int runs)
+{
+	File capture;
+
+	if (!capture.OpenForRead(path))
+	{
+		LOG_ERROR("Failed to open ray capture %s", path);
+		return false;
+	}
+
+	Header header;
+
+	if (capture.size < sizeof(Header))
+	{
+		LOG_ERROR("%s isn't a ray capture", path);
+		return false;
+	}
+
+	memcpy(&header, capture.contents, sizeof(header));
+
+	if (memcmp(header.magic, Header().magic, sizeof(header.magic)) != 0 || header.version != Header().version)
+	{
+		LOG_ERROR("%s isn't a ray capture, or was written by a different version", path);
+		return false;
+	}
+
+	if (capture.size < sizeof(Header) + sizeof(Record) * header.count)
+	{
+		LOG_ERROR("Ray capture %s is truncated", path);
+		return false;
+	}
+
+	if (header.scene != HashScene(scene))
+	{
+		LOG_ERROR("Ray capture %s was made with a different scene", path);
+		return false;
+	}
+
+	const Record* records = reinterpret_cast<const Record*>(static_cast<const uint8_t*>(capture.contents) + sizeof(Header));
+
+	const uint64_t count = header.count;
+
+	// Check the results once, then time the queries alone
+
+	uint64_t mismatches = 0;
+	uint64_t occlusion = 0;
+
+	for (uint64_t i = 0; i < count; ++i)
+	{
+		const Record& record = records[i];
+
+		const Ray ray(record.origin, record.direction);
+
+		bool hit;
+		float t = 0;
+
+		if (record.flags & Occlusion)
+		{
+			hit = scene.Hit(ray);
+			++occlusion;
+		}
+		else
+		{
+			Intersection intersection;
+
+			hit = scene.Hit(intersection, ray);
+			t = intersection.t;
+		}
+
+		if (Matches(record, hit, t))
+			continue;
+
+		if (mismatches < max_logged_mismatches)
+			LOG_WARNING("Ray %llu: %s at %f, expected %s at %f", i, hit ? "hit" : "miss", t, (record.flags & Hit) ? "hit" : "miss", record.t);
+
+		++mismatches;
+	}
+
+	LOG_INFO("Replaying %llu rays (%llu occlusion queries) from %s", count, occlusion, path);
+
+	float durations[1024];
+
+	runs = Clamp(runs, 1, countof(durations));
+
+	// Results are kept alive through a volatile sink so that the queries aren't optimized away
+
+	volatile uint64_t sink = 0;
+
+	for (int run = 0; run < runs; ++run)
+	{
+		const uint64_t start = Time::Now();
+
+		uint64_t hits = 0;
+
+		for (uint64_t i = 0; i < count; ++i)
+		{
+			const Record& record = records[i];
+
+			const Ray ray(record.origin, record.direction);
+
+			if (record.flags & Occlusion)
+				hits += scene.Hit(ray);
+			else
+			{
+				Intersection intersection;
+				hits += scene.Hit(intersection, ray);
+			}
+		}
+
+		durations[run] = Time::Elapsed(start, Time::Now());
+
+		sink = sink + hits;
+	}
+
+	std::sort(durations, durations + runs);
+
+	const float median = durations[runs / 2];
+
+	LOG_INFO("Replay: median = %.3f s, min = %.3f s, efficiency = %.2f Mray/s", median, durations[0], median > 0 ? count * 0.000001 / median : 0.0);
+
+	if (mismatches > 0)
+	{
+		LOG_ERROR("%llu of %llu rays didn't match the capture", mismatches, count);
+		return false;
+	}
+
+	return true;
+}
+
+uint64_t RayCapture::HashScene(const Scene& scene)
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+
+	for (const SphereShape& sphere : scene.spheres)
+	{
+		Hash(hash, &sphere.center, sizeof(sphere.center));
+		Hash(hash, &sphere.radius, sizeof(sphere.radius));
+	}
+
+	for (const PlaneShape& plane : scene.planes)
+	{
+		Hash(hash, &plane.point, sizeof(plane.point));
+		Hash(hash, &plane.normal, sizeof(plane.normal));
+	}
+
+	return hash;
+}
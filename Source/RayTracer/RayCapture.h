@@ -0,0 +1,129 @@
+#pragma once
+
+#include <Math/Ray.h>
+#include <Core/Types.h>
+
+struct Allocator;
+struct Scene;
+
+// Records every ray passed to Scene::Hit during a render, with the result of the query, so
+// that the same stream of rays can be replayed later without any shading. Replaying checks
+// the hits against the recorded ones and measures the intersection throughput, which makes
+// changes to intersection comparable between builds.
+//
+// Capture files are a Header followed by the records, in the order the workers flushed them.
+//
+namespace RayCapture
+{
+	enum Flags : uint32_t
+	{
+		// The ray was an occlusion query rather than a closest hit query
+		//
+		Occlusion = 1 << 0,
+
+		// The ray hit something
+		//
+		Hit = 1 << 1,
+	};
+
+	struct Header
+	{
+		// File identifier and format version
+		//
+		char magic[4] = { 'R', 'A', 'Y', 'S' };
+		uint32_t version = 1;
+
+		// Number of records following the header
+		//
+		uint64_t count = 0;
+
+		// Hash of the scene geometry the rays were cast against
+		//
+		uint64_t scene = 0;
+	};
+
+	struct Record
+	{
+		float3 origin;
+		float3 direction;
+
+		// Distance to the closest hit, or zero for occlusion queries and misses
+		//
+		float t;
+
+		// Combination of Flags
+		//
+		uint32_t flags;
+	};
+
+	static_assert(sizeof(Record) == 32, "Capture records are meant to be 32 bytes");
+
+	struct ThreadCapture
+	{
+		// Write the buffered records to the file
+		//
+		void Flush();
+
+		// Records not yet written to the file
+		//
+		Record* records = nullptr;
+		int count = 0;
+	};
+
+	// Start capturing the rays of later renders to the file. Each worker buffers records and
+	// writes them out as the buffer fills up.
+	//
+	bool Start(Allocator& allocator, const char* path, const Scene& scene);
+
+	// Finish the file and stop capturing
+	//
+	bool Stop();
+
+	// Notify that a render will start with the given number of workers
+	//
+	void OnStartRender(int workers);
+
+	// Notify that a worker thread is starting or has run out of work
+	//
+	void OnStartWorker(int worker);
+	void OnFinishWorker(int worker);
+
+	// Replay the rays in the file against the scene the given number of times, checking the
+	// results and logging the throughput
+	//
+	bool Replay(const char* path, const Scene& scene, int runs);
+
+	// Return a hash of the scene geometry, to check that rays are replayed against the scene
+	// they were captured from
+	//
+	uint64_t HashScene(const Scene& scene);
+
+	// Records in each worker's buffer
+	//
+	constexpr int buffer_capacity = 16 * 1024;
+
+	// Capture of the current thread, or null if it isn't capturing
+	//
+	extern thread_local ThreadCapture* Current;
+
+	// Record a ray cast by Scene::Hit. Compiled out of final builds.
+	//
+	inline void OnHit(const Ray& ray, float t, uint32_t flags)
+	{
+#ifndef FINAL_BUILD
+		ThreadCapture* capture = Current;
+
+		if (!capture)
+			return;
+
+		capture->records[capture->count++] = { ray.p, ray.d, t, flags };
+
+		if (capture->count == buffer_capacity)
+			capture->Flush();
+#else
+		unused(ray);
+		unused(t);
+		unused(flags);
+#endif
+	}
+}
@@ -0,0 +1,250 @@
+#include <RayTracer/RenderTarget.h>
+#include <RayTracer/ToneMap.h>
+#include <Image/Pfm.h>
+#include <Image/Tga.h>
+#include <Math/Scalar.h>
+#include <System/Window.h>
+#include <Core/Constants.h>
+#include <Core/Memory.h>
+#include <Core/Scratch.h>
+#include <Core/String.h>
+#include <Core/Log.h>
+#include <cstring>
+
+namespace
+{
+	// Framebuffers at least this large are mapped from the system rather than the heap, as
+	// they span enough pages for their NUMA placement to matter
+	//
+	constexpr size_t first_touch_size = 2_MiB;
+}
+
+void RenderTarget::BeginTile(Tile tile)
+{
+	unused(tile);
+}
+
+void RenderTarget::WriteSamples(Tile tile, const SampleSum* sums)
+{
+	ScratchScope scratch;
+
+	float3* texels = scratch.NewArray<float3>(tile.w * tile.h);
+
+	for (int i = 0; i < tile.w * tile.h; ++i)
+		texels[i] = sums[i].GetMean();
+
+	WriteTile(tile, texels);
+}
+
+bool RenderTarget::IsTileComplete(Tile tile) const
+{
+	unused(tile);
+
+	return false;
+}
+
+FramebufferTarget::FramebufferTarget(Allocator& allocator, int w, int h) : allocator(&allocator)
+{
+	pages.tag = Memory::Tag::Framebuffers;
+
+	CreateFramebuffer(w, h);
+}
+
+int FramebufferTarget::GetWidth() const
+{
+	return radiance.w;
+}
+
+int FramebufferTarget::GetHeight() const
+{
+	return radiance.h;
+}
+
+void FramebufferTarget::WriteTile(Tile tile, const float3* texels)
+{
+	for (int y = 0; y < tile.h; ++y)
+		memcpy(&radiance(tile.x, tile.y + y), texels + y * tile.w, sizeof(float3) * tile.w);
+}
+
+void FramebufferTarget::Resize(int w, int h)
+{
+	if (radiance.w == w && radiance.h == h)
+		return;
+
+	CreateFramebuffer(w, h);
+}
+
+void FramebufferTarget::CreateFramebuffer(int w, int h)
+{
+	Memory::TagScope tag(Memory::Tag::Framebuffers);
+
+	radiance = Image<float3>();
+
+	// Large framebuffers are mapped straight from the system and left untouched, so that each
+	// page is first touched by the worker that writes a tile to it and placed on that worker's
+	// NUMA node. Freshly mapped pages are already zero.
+
+	const size_t size = sizeof(float3) * w * h;
+
+	if (size >= first_touch_size)
+	{
+		radiance = Image<float3>(pages, static_cast<float3*>(pages.Allocate(size, alignof(float3))), w, h);
+		return;
+	}
+
+	radiance = Image<float3>(*allocator, w, h);
+	radiance.Fill(float3(0.0f));
+}
+
+bool FramebufferTarget::Save(const char* path, const ToneMap::Settings& settings) const
+{
+	const char* extension = strrchr(path, '.');
+
+	const int count = radiance.w * radiance.h;
+
+	if (extension && String::CompareNoCase(extension, ".pfm") == 0)
+	{
+		Image<float3> exposed(Memory::TempAllocator(), radiance.w, radiance.h);
+
+		for (int i = 0; i < count; ++i)
+			exposed[i] = radiance[i] * settings.exposure;
+
+		return Pfm::SaveImage(path, exposed);
+	}
+
+	if (extension && String::CompareNoCase(extension, ".tga") == 0)
+	{
+		Image<Bgra> display(Memory::TempAllocator(), radiance.w, radiance.h);
+
+		ToneMap::ToDisplay(display.texels, radiance.texels, count, settings);
+
+		return Tga::SaveImage(path, display);
+	}
+
+	LOG_ERROR("Can't save %s because the format isn't supported (expected .pfm or .tga)", path);
+
+	return false;
+}
+
+bool FramebufferTarget::Load(const char* path, const ToneMap::Settings& settings)
+{
+	Image<float3> exposed;
+
+	if (!Pfm::LoadImage(exposed, Memory::TempAllocator(), path))
+		return false;
+
+	Resize(exposed.w, exposed.h);
+
+	const int count = radiance.w * radiance.h;
+
+	for (int i = 0; i < count; ++i)
+		radiance[i] = exposed[i] / settings.exposure;
+
+	return true;
+}
+
+void FramebufferTarget::CalculateError(const Image<Bgra>& reference, const ToneMap::Settings& settings) const
+{
+	if (!reference.texels)
+	{
+		LOG_ERROR("Can't calculate variance because there is no reference image");
+		return;
+	}
+
+	if (reference.w != radiance.w || reference.h != radiance.h)
+	{
+		LOG_ERROR("The reference image has different dimensions to the display image");
+		return;
+	}
+
+	Image<Bgra> render(Memory::TempAllocator(), radiance.w, radiance.h);
+
+	ToneMap::ToDisplay(render.texels, radiance.texels, radiance.w * radiance.h, settings);
+
+	float squared_error_sum = 0;
+	float value_sum = 0;
+
+	const int count = reference.w * reference.h;
+
+	for (int i = 0; i < count; ++i)
+	{
+		const float3 cref = reference[i].ToLinear();
+		const float3 cdis = render[i].ToLinear();
+
+		squared_error_sum += Square(CalculateLuminance(cdis - cref));
+		value_sum += CalculateLuminance(cref);
+	}
+
+	const float mean = value_sum / count;
+
+	const float mse = squared_error_sum / count;
+	const float rms = Sqrt(mse) / mean;
+
+	LOG_INFO("MSE: %.6f, RMS: %.2f %%", mse, rms * 100);
+}
+
+WindowTarget::WindowTarget(Allocator& allocator, Window& window) : FramebufferTarget(allocator, window.w, window.h), window(window)
+{
+}
+
+void WindowTarget::BeginTile(Tile tile)
+{
+	// Fill the tile with orange while we're working on it
+
+	ScratchScope scratch;
+
+	Bgra* texels = scratch.NewArray<Bgra>(tile.w * tile.h);
+
+	for (int i = 0; i < tile.w * tile.h; ++i)
+		texels[i] = { 30, 192, 255 };
+
+	window.Blit(texels, tile.x, tile.y, tile.w, tile.h);
+}
+
+void WindowTarget::WriteTile(Tile tile, const float3* texels)
+{
+	FramebufferTarget::WriteTile(tile, texels);
+
+	ToneMap::Settings settings;
+
+	{
+		ScopedLock lock(mutex);
+		settings = tonemap;
+	}
+
+	ScratchScope scratch;
+
+	Bgra* display = scratch.NewArray<Bgra>(tile.w * tile.h);
+
+	ToneMap::ToDisplay(display, texels, tile.w * tile.h, settings);
+
+	window.Blit(display, tile.x, tile.y, tile.w, tile.h);
+}
+
+void WindowTarget::SetToneMap(const ToneMap::Settings& settings)
+{
+	{
+		ScopedLock lock(mutex);
+		tonemap = settings;
+	}
+
+	Present();
+}
+
+void WindowTarget::Present()
+{
+	ToneMap::Settings settings;
+
+	{
+		ScopedLock lock(mutex);
+		settings = tonemap;
+	}
+
+	// Tiles that are still being rendered will show the previous result until they are written
+
+	Image<Bgra> display(Memory::TempAllocator(), radiance.w, radiance.h);
+
+	ToneMap::ToDisplay(display.texels, radiance.texels, radiance.w * radiance.h, settings);
+
+	window.Blit(display.texels, 0, 0, display.w, display.h);
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <RayTracer/ToneMap.h>
+#include <RayTracer/Tile.h>
+#include <Image/Image.h>
+#include <Math/Vector.h>
+#include <System/SystemAllocator.h>
+#include <System/Mutex.h>
+
+struct Window;
+
+// Sum of the radiance samples taken for a pixel. Sums are kept in double precision so that
+// partial sums over separate sample ranges can be added up later and give the same mean as a
+// single pass, other than in the last bit of the double.
+//
+struct SampleSum
+{
+	void Add(float3 radiance)
+	{
+		r += radiance.r;
+		g += radiance.g;
+		b += radiance.b;
+		++count;
+	}
+
+	void Add(const SampleSum& other)
+	{
+		r += other.r;
+		g += other.g;
+		b += other.b;
+		count += other.count;
+	}
+
+	float3 GetMean() const
+	{
+		return count > 0 ? float3(float(r / count), float(g / count), float(b / count)) : float3(0.0f);
+	}
+
+	double r = 0;
+	double g = 0;
+	double b = 0;
+
+	uint32_t count = 0;
+};
+
+struct RenderTarget
+{
+	virtual ~RenderTarget() = default;
+
+	// Return the dimensions in pixels
+	//
+	virtual int GetWidth() const = 0;
+	virtual int GetHeight() const = 0;
+
+	// Called by a worker thread when it starts rendering a tile
+	//
+	virtual void BeginTile(Tile tile);
+
+	// Called by a worker thread with the radiance for a completed tile, stored as
+	// tile.w x tile.h values in row order. Tiles never overlap, so no locking is needed.
+	//
+	virtual void WriteTile(Tile tile, const float3* radiance) = 0;
+
+	// Called by a worker thread with the sample sums for a completed tile, stored like the
+	// radiance above. By default the mean radiance is passed on to WriteTile. Tasks refining a
+	// region can overlap tiles that are still being rendered, so only targets that lock can
+	// be refined.
+	//
+	virtual void WriteSamples(Tile tile, const SampleSum* sums);
+
+	// Return true if the tile already holds its final result, e.g. from a resumed render, so
+	// that it can be skipped
+	//
+	virtual bool IsTileComplete(Tile tile) const;
+};
+
+struct FramebufferTarget : RenderTarget
+{
+	FramebufferTarget(Allocator& allocator, int w, int h);
+
+	int GetWidth() const override;
+	int GetHeight() const override;
+
+	void WriteTile(Tile tile, const float3* radiance) override;
+
+	// Reallocate the framebuffer if the dimensions have changed. Must not be called during a render
+	//
+	void Resize(int w, int h);
+
+	// Save to disk as .pfm (exposed, full range) or .tga (tone mapped), chosen by extension
+	//
+	bool Save(const char* path, const ToneMap::Settings& settings) const;
+
+	// Load a .pfm saved with the same exposure, resizing to match it, so that regions can be
+	// rendered over an earlier render
+	//
+	bool Load(const char* path, const ToneMap::Settings& settings);
+
+	// Log the error of the tone mapped framebuffer against a reference image
+	//
+	void CalculateError(const Image<Bgra>& reference, const ToneMap::Settings& settings) const;
+
+	// Allocate a cleared framebuffer, releasing the old one first so that both are never
+	// allocated at once
+	//
+	void CreateFramebuffer(int w, int h);
+
+	// Allocator for small framebuffers
+	//
+	Allocator* allocator = nullptr;
+
+	// Pages mapped for large framebuffers
+	//
+	PageAllocator pages;
+
+	// Radiance for each pixel, before exposure and tone mapping. This persists between renders
+	// so that the display can be regenerated without tracing any rays.
+	//
+	Image<float3> radiance;
+};
+
+struct WindowTarget : FramebufferTarget
+{
+	WindowTarget(Allocator& allocator, Window& window);
+
+	// Mark the tile as in progress on the window
+	//
+	void BeginTile(Tile tile) override;
+
+	// Store the tile and blit the tone mapped result to the window
+	//
+	void WriteTile(Tile tile, const float3* radiance) override;
+
+	// Change the tone mapping and redisplay the whole framebuffer. Can be called during a render
+	//
+	void SetToneMap(const ToneMap::Settings& settings);
+
+	// Tone map the whole framebuffer and blit it to the window
+	//
+	void Present();
+
+	// Native window
+	//
+	Window& window;
+
+	// Tone mapping for the display
+	//
+	ToneMap::Settings tonemap;
+
+	// Guards the tone mapping settings, which the workers read for every tile
+	//
+	mutable Mutex mutex;
+};
@@ -1,99 +1,287 @@
 #include <RayTracer/Renderer.h>
+#include <RayTracer/Aov.h>
+#include <RayTracer/RenderTarget.h>
 #include <RayTracer/Integrator/Integrator.h>
 #include <RayTracer/Brdf/FireflyReduction.h>
 #include <RayTracer/Sampler.h>
 #include <RayTracer/Camera.h>
+#include <RayTracer/Profiler.h>
 #include <RayTracer/Tile.h>
 #include <RayTracer/Scene.h>
-#include <Image/Texel.h>
-#include <System/Window.h>
+#include <System/Host.h>
 #include <Core/Memory.h>
+#include <Core/Scratch.h>
+#include <Core/Generic.h>
+#include <Core/Log.h>
 
 namespace
 {
-	float3 ToneMap(float3 x)
+	void RenderTask(void* context, int task)
 	{
-		const float3 a = float3(2.51f);
-		const float3 b = float3(0.03f);
-		const float3 c = float3(2.43f);
-		const float3 d = float3(0.59f);
-		const float3 e = float3(0.14f);
+		Renderer& renderer = *static_cast<Renderer*>(context);
 
-		return Saturate((x*(a*x + b)) / (x*(c*x + d) + e));
+		RenderTarget& target = *renderer.target;
+
+		const Tile tile = renderer.task_tiles[task];
+
+		// Tiles restored from a checkpoint are already done
+
+		if (target.IsTileComplete(tile))
+			return;
+
+		PROFILE_SCOPE(Task);
+
+		const int2 samples = renderer.task_samples[task];
+
+		const float error = renderer.RenderTile(target, tile, samples.x, samples.y, *renderer.camera, *renderer.scene, *renderer.integrator, renderer.measure_costs ? &renderer.costs : nullptr, renderer.aovs);
+
+		// Don't overwrite the previous estimate with the result from a partial tile
+
+		if (!renderer.scheduler.IsCancelled())
+			renderer.errors[renderer.tiler.tiles[renderer.tasks[task]]] = error;
 	}
 
-	//float3 ToneMap(float3 x)
-	//{
-	//	return Saturate(x);
-	//}
+	// Return the bounding box of the parts of the tile inside any of the regions. Pixels
+	// between regions in the same tile are rendered too, so that no pixel is ever written by
+	// two tasks.
+	//
+	Tile CropToRegions(Tile tile, const Tile* regions, int count)
+	{
+		Tile bounds(0, 0, 0, 0);
+
+		for (int i = 0; i < count; ++i)
+		{
+			const Tile overlap = tile.Intersect(regions[i]);
+
+			if (overlap.IsEmpty())
+				continue;
+
+			if (bounds.IsEmpty())
+			{
+				bounds = overlap;
+				continue;
+			}
+
+			const int x0 = Min(bounds.x, overlap.x);
+			const int y0 = Min(bounds.y, overlap.y);
+			const int x1 = Max(bounds.x + bounds.w, overlap.x + overlap.w);
+			const int y1 = Max(bounds.y + bounds.h, overlap.y + overlap.h);
+
+			bounds = Tile(x0, y0, x1 - x0, y1 - y0);
+		}
+
+		return bounds;
+	}
+}
+
+Renderer::Renderer(int quality, int worker_count) : quality(quality), scheduler(worker_count > 0 ? worker_count : Host::GetCpuCoreCount())
+{
+}
+
+void Renderer::Render(RenderTarget& target_, const Camera& camera_, const Scene& scene_, const Integrator& integrator_, const Tile* regions, int region_count)
+{
+	Start(target_, camera_, scene_, integrator_, CenterPriority(target_.GetWidth(), target_.GetHeight()), regions, region_count);
+	Wait();
+}
+
+void Renderer::Start(RenderTarget& target_, const Camera& camera_, const Scene& scene_, const Integrator& integrator_, const TilePriority& priority, const Tile* regions, int region_count)
+{
+	ASSERT(!IsRunning(), "A render is already in progress");
+
+	target = &target_;
+	camera = &camera_;
+	scene = &scene_;
+	integrator = &integrator_;
+
+	const int w = target->GetWidth();
+	const int h = target->GetHeight();
+
+	ASSERT(!aovs || (aovs->w == w && aovs->h == h && aovs->tile_size == tile_size), "The AOV buffer doesn't match the render");
+
+	Stats::OnStartRender(w, h, quality, scheduler.worker_count);
+
+	tiler = Tiler();
+	tiler = MortonTiler(pages, w, h, tile_size);
+
+	// Keep the error estimates from the previous render if the tile layout hasn't changed
+	// so that they can be used to prioritize this one.
 
-	Bgra TransformToDisplaySpace(float3 x)
+	if (errors.w != tiler.tiles.w || errors.h != tiler.tiles.h)
 	{
-		const float3 gamma = LinearToGamma(x);
+		errors = Image<float>();
+		errors = Image<float>(pages, tiler.tiles.w, tiler.tiles.h);
+		errors.Fill(0.0f);
+	}
+
+	if (measure_costs && (costs.w != w || costs.h != h))
+	{
+		Memory::TagScope tag(Memory::Tag::Framebuffers);
 
-		return { uint8_t(gamma.b * 255), uint8_t(gamma.g * 255), uint8_t(gamma.r * 255) };
+		costs = Image<float>(Memory::TempAllocator(), w, h);
+		costs.Fill(0.0f);
 	}
+
+	// Only keep room for refinement tasks when they can be added, since the task arrays are
+	// large with small tiles
+
+	const int capacity = refinable ? 2 * tiler.count : tiler.count;
+
+	tasks = Array<int>();
+	task_tiles = Array<Tile>();
+	task_samples = Array<int2>();
+
+	tasks = Array<int>(pages, capacity);
+	task_tiles = Array<Tile>(pages, capacity);
+	task_samples = Array<int2>(pages, capacity);
+
+	task_count = 0;
+
+	AddTasks(regions, region_count, first_sample, last_sample);
+
+	Array<float> priorities(pages, task_count);
+
+	for (int i = 0; i < task_count; ++i)
+		priorities[i] = priority.Evaluate(task_tiles[i]);
+
+	scheduler.Start(pages, RenderTask, this, priorities.values, task_count, tasks.count - task_count);
 }
 
-void Renderer::Render(Window& window, const Camera& camera, const Scene& scene, const Integrator& integrator) const
+bool Renderer::Refine(const Tile* regions, int region_count, int first, int last)
 {
-	Stats::OnStartRender(window.w, window.h, quality);
+	if (!IsRunning())
+		return false;
+
+	// The workers only read the tasks the scheduler hands them, so new tasks can be written
+	// after the others while the render is running
+
+	const int first_task = task_count;
+
+	if (!AddTasks(regions, region_count, first, last) || !scheduler.Push(first_task, task_count - first_task))
+	{
+		task_count = first_task;
+		return false;
+	}
 
-	MortonTiler tiler(Memory::TempAllocator(), window.w, window.h, 16);
+	return true;
+}
 
-	#pragma omp parallel for schedule(dynamic)
+bool Renderer::AddTasks(const Tile* regions, int region_count, int first, int last)
+{
+	// Clip tiles on the right and bottom edges to the target, and skip any outside the regions
 
 	for (int i = 0; i < tiler.count; ++i)
-		RenderTile(window, tiler.GenerateTile(i), camera, scene, integrator);
+	{
+		Tile tile = tiler.GenerateTile(i).Clip(target->GetWidth(), target->GetHeight());
+
+		if (region_count > 0)
+			tile = CropToRegions(tile, regions, region_count);
+
+		if (tile.IsEmpty())
+			continue;
+
+		if (task_count == tasks.count)
+			return false;
+
+		tasks[task_count] = i;
+		task_tiles[task_count] = tile;
+		task_samples[task_count] = int2(first, last);
+
+		++task_count;
+	}
+
+	return true;
+}
+
+void Renderer::Cancel()
+{
+	scheduler.Cancel();
+}
+
+bool Renderer::Wait()
+{
+	if (!scheduler.Wait())
+	{
+		LOG_INFO("Render cancelled");
+		return false;
+	}
 
 	Stats::OnFinishRender();
 	Stats::Log();
+
+	return true;
+}
+
+bool Renderer::IsRunning() const
+{
+	return scheduler.IsRunning();
 }
 
-void Renderer::RenderTile(Window& window, Tile tile, const Camera& camera, const Scene& scene, const Integrator& integrator) const
+float Renderer::RenderTile(RenderTarget& target, Tile tile, int first, int last, const Camera& camera, const Scene& scene, const Integrator& integrator, Image<float>* costs, AovBuffer* aovs) const
 {
-	// We're going to render one tw x th tile into the ww x wh window  at the origin (ox, oy) 
+	// We're going to render one tw x th tile into the ww x wh target at the origin (ox, oy) 
 	// determined by the tile index.
 
-	const int ww = window.w;
-	const int wh = window.h;
+	const int ww = target.GetWidth();
+	const int wh = target.GetHeight();
+
+	// Tiles can be any size, so their buffers come from the worker's own scratch memory
 
-	// Fill the tile with orange and blit to the window while we're working on it
+	ScratchScope scratch;
 
-	Bgra texels[4096];
+	const int pixel_count = tile.w * tile.h;
 
-	ASSERT(tile.w * tile.h < sizeof(texels));
+	SampleSum* sums = scratch.NewArray<SampleSum>(pixel_count);
 
-	for (int i = 0; i < tile.w * tile.h; ++i)
-		texels[i] = { 30, 192, 255 };
+	// AOVs are summed in planes like the AOV buffer and only added to it once the tile is done
 
-	window.Blit(texels, tile.x, tile.y, tile.w, tile.h);
+	float* aov_sums = aovs ? scratch.NewArray<float>(aovs->GetPlaneCount() * pixel_count) : nullptr;
 
-	// Sum up all AA samples from the path tracer to get final radiance values and then
-	// tone map, convert to gamma space and quantize to window format.
+	target.BeginTile(tile);
+
+	// Sum up the AA samples in the sample range from the path tracer. Averaging, exposure, tone
+	// mapping and quantization are left to the target so they can change without re-rendering.
 
 	CorrelatedMultiJitterSampler sampler(quality);
 
-	const int samples = sampler.GetSampleCount();
-	const float dw = 1.0f / samples;
+	const int sample_count = sampler.GetSampleCount();
+
+	const int end = last > 0 ? last : sample_count;
+	const int begin = Min(first, end);
+
+	float error_sum = 0;
 
 	for (int y = 0; y < tile.h; ++y)
 	{
 		for (int x = 0; x < tile.w; ++x)
 		{
+			// Bail out as soon as the render is cancelled, leaving the tile unfinished
+
+			if (scheduler.IsCancelled())
+				return 0;
+
 			const int px = tile.x + x;
 			const int py = tile.y + y;
 
 			sampler.StartPixel(px, py);
+			sampler.SetSample(begin);
 
-			Random::SetSeed(sampler.pattern);
+			SampleSum& sum = sums[y * tile.w + x];
+
+			sum = SampleSum();
 
 			float3 radiance[2] = { { 0, 0, 0 }, { 0, 0, 0 } };
 
-			for (int s = 0; s < samples; ++s)
+			const uint64_t start = costs ? Profiler::ReadCycles() : 0;
+
+			for (int s = begin; s < end; ++s)
 			{
 				FireflyReduction::RegisterNewSample();
 
+				// Give every sample its own random stream so that it doesn't depend on which
+				// samples were rendered before it
+
+				Random::SetSeed(uint64_t(uint32_t(sampler.pattern)) << 32 | uint32_t(s));
+
 				sampler.StartSample();
 
 				const float2 sample = sampler.Get();
@@ -101,25 +289,43 @@ void Renderer::RenderTile(Window& window, Tile tile, const Camera& camera, const
 				const float u = (px + sample.x) * 2.0f / ww - 1.0f;
 				const float v = (py + sample.y) * 2.0f / wh - 1.0f;
 
-				radiance[s & 1] += integrator.Li(sampler, camera.GenerateRay(u, v, sampler.Get()), scene) * dw;
+				AovSample aov;
+
+				const float3 li = integrator.Li(sampler, camera.GenerateRay(u, v, sampler.Get()), scene, aovs ? &aov : nullptr);
+
+				if (aovs)
+					aovs->AddSample(aov_sums, pixel_count, y * tile.w + x, aov);
+
+				radiance[s & 1] += li;
+
+				sum.Add(li);
 			}
 
+			if (costs)
+				(*costs)(px, py) += float(Profiler::ReadCycles() - start);
+
 			// Calculate error metric
 			//
 			// https://jo.dreggn.org/home/2009_stopping.pdf
 
-			const float3 a = radiance[0] * camera.exposure;
-			const float3 b = radiance[1] * camera.exposure;
+			const float3 a = radiance[0];
+			const float3 b = radiance[1];
 			const float3 c = a + b;
 			const float3 d = Abs(b - a);
 
-			const float error = CalculateLuminance(d) / CalculateLuminance(c);
+			const float luminance = CalculateLuminance(c);
 
-			texels[y * tile.w + x] = TransformToDisplaySpace(ToneMap(c));
+			if (luminance > 0)
+				error_sum += CalculateLuminance(d) / luminance;
 		}
 	}
 
-	// Finally, blit the completed tile to the correct part of the window
+	// Finally, hand the completed tile over to the target
+
+	target.WriteSamples(tile, sums);
+
+	if (aovs)
+		aovs->AddTile(tile, aov_sums);
 
-	window.Blit(texels, tile.x, tile.y, tile.w, tile.h);
+	return error_sum / pixel_count;
 }
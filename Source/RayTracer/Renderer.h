@@ -1,24 +1,129 @@
 #pragma once
 
-struct Tile;
-struct Window;
+#include <RayTracer/Scheduler.h>
+#include <RayTracer/Tile.h>
+#include <Math/Vector.h>
+#include <System/SystemAllocator.h>
+
+struct RenderTarget;
 struct Camera;
 struct Scene;
 struct Integrator;
+struct AovBuffer;
 
 struct Renderer
 {
-	Renderer(int quality) : quality(quality) {}
+	// A worker count of 0 uses every core
+	//
+	Renderer(int quality, int worker_count = 0);
+
+	// Render the scene to the target immediately. If any regions are given, only the pixels in
+	// them are rendered and the rest of the target is left as it is.
+	//
+	void Render(RenderTarget& target, const Camera& camera, const Scene& scene, const Integrator& integrator, const Tile* regions = nullptr, int region_count = 0);
+
+	// Start rendering the scene to the target in the background, most important tiles first.
+	// The priority and regions are only used during this call.
+	//
+	void Start(RenderTarget& target, const Camera& camera, const Scene& scene, const Integrator& integrator, const TilePriority& priority, const Tile* regions = nullptr, int region_count = 0);
+
+	// Render the samples [first, last) for the pixels in the regions ahead of the rest of the
+	// current render, without cancelling it. Returns false if the render has finished or has
+	// no room left for more tasks, in which case nothing is queued.
+	//
+	bool Refine(const Tile* regions, int region_count, int first, int last);
+
+	// Stop the current render as soon as possible
+	//
+	void Cancel();
 
-	// Render the scene to the window immediately
+	// Wait for the current render to finish and log the stats. Returns false if it was cancelled
 	//
-	void Render(Window& window, const Camera& camera, const Scene& scene, const Integrator& integrator) const;
+	bool Wait();
 
-	// Render a tile
+	// Return true if a background render is in progress
 	//
-	void RenderTile(Window& window, Tile tile, const Camera& camera, const Scene& scene, const Integrator& integrator) const;
+	bool IsRunning() const;
+
+	// Add tasks for the parts of the tiles inside the regions, or for whole tiles if there are
+	// no regions. Returns false if there isn't room for all of them.
+	//
+	bool AddTasks(const Tile* regions, int region_count, int first, int last);
+
+	// Render the samples [first, last) of a tile and return its mean error estimate. A last
+	// sample of 0 renders up to the sample count for the quality. If costs are given, the
+	// cycles spent on each pixel are added to the matching pixel of them, and if AOVs are
+	// given the sums of the AOV samples are added to them.
+	//
+	float RenderTile(RenderTarget& target, Tile tile, int first, int last, const Camera& camera, const Scene& scene, const Integrator& integrator, Image<float>* costs = nullptr, AovBuffer* aovs = nullptr) const;
 
 	// Overall quality settings
 	//
 	int quality = 1;
+
+	// Range of samples to render for each pixel, [first_sample, last_sample). A last sample of
+	// 0 renders up to the sample count for the quality. Ranges of the same frame rendered
+	// separately can be merged into the full render, and ranges past the sample count add
+	// more samples to it.
+	//
+	int first_sample = 0;
+	int last_sample = 0;
+
+	// Tile size in pixels
+	//
+	int tile_size = 16;
+
+	// Pages for the tile order, error estimates and tasks. These scale with the tile count,
+	// which for large renders with small tiles is more than the temp allocator holds.
+	//
+	PageAllocator pages;
+
+	// Mean error estimate for each tile of the last render
+	//
+	Image<float> errors;
+
+	// Measure the cycles spent on each pixel
+	//
+	bool measure_costs = false;
+
+	// Cycles spent on each pixel, summed over renders until the target size changes, so that
+	// renders made of several passes are measured as a whole
+	//
+	Image<float> costs;
+
+	// Keep room in each render for a frame of Refine tasks
+	//
+	bool refinable = false;
+
+	// AOV framebuffer to add the AOVs of each render to, or null for none. It must match the
+	// size of the target and the tile size.
+	//
+	AovBuffer* aovs = nullptr;
+
+	// Tile order for the current render
+	//
+	Tiler tiler;
+
+	// Tiler index, pixels and sample range to render for each task of the current render.
+	// Tasks only cover the parts of tiles inside the render regions. Refinable renders have
+	// room for a full frame of refinement tasks after the tasks they started with.
+	//
+	Array<int> tasks;
+	Array<Tile> task_tiles;
+	Array<int2> task_samples;
+
+	// Number of tasks in use
+	//
+	int task_count = 0;
+
+	// Worker threads
+	//
+	Scheduler scheduler;
+
+	// Render targets for the current render
+	//
+	RenderTarget* target = nullptr;
+	const Camera* camera = nullptr;
+	const Scene* scene = nullptr;
+	const Integrator* integrator = nullptr;
 };
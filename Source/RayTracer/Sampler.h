@@ -22,7 +22,7 @@ struct Sampler
 	//
 	virtual float2 Get() = 0;
 
-	// Return the max sample count
+	// Return the sample count for a full render
 	//
 	virtual int GetSampleCount() const = 0;
 };
@@ -99,7 +99,7 @@ struct MersenneTwisterRandomSampler : Sampler
 
 	float Real()
 	{
-		const std::uniform_real_distribution<float> distribution(0, 1);
+		std::uniform_real_distribution<float> distribution(0, 1);
 		return distribution(engine);
 	}
 
@@ -215,7 +215,8 @@ struct CorrelatedMultiJitterSampler : Sampler
 
 	void StartPixel(int x, int y) override
 	{
-		pattern = MortonCode::Encode(x, y);
+		pixel_pattern = MortonCode::Encode(x, y);
+		pattern = pixel_pattern;
 		sample = -1;
 	}
 
@@ -224,7 +225,25 @@ struct CorrelatedMultiJitterSampler : Sampler
 		dimension = 0;
 		sample++;
 
-		ASSERT(sample < n * n);
+		// Samples past the first n x n carry on with a fresh set of n x n samples from
+		// another pattern, so that more samples can be added to a finished pixel
+
+		if (sample == n * n)
+		{
+			pattern = int(uint(pattern) + pass_stride);
+			sample = 0;
+		}
+	}
+
+	// Skip ahead so that the next sample started is the given index. Every sample only depends
+	// on the pattern and its index, so any range of samples can be rendered on its own.
+	//
+	void SetSample(int index)
+	{
+		ASSERT(index >= 0);
+
+		pattern = int(uint(pixel_pattern) + uint(index / (n * n)) * pass_stride);
+		sample = index % (n * n) - 1;
 	}
 
 	float2 Get() override
@@ -309,11 +328,20 @@ struct CorrelatedMultiJitterSampler : Sampler
 		return (i + p) % l;
 	}
 
+	// Offset between the patterns of successive sets of n x n samples. It's far from the
+	// dimension offsets so that the sets don't share patterns.
+	//
+	static constexpr uint pass_stride = 0x9e3779b9;
+
 	// Square root of the sample count
 	//
 	int n = 0;
 
-	// Base pattern index
+	// Pattern index for the first n x n samples of the pixel
+	//
+	int pixel_pattern = 0;
+
+	// Base pattern index for the current set of n x n samples
 	//
 	int pattern = 0;
 
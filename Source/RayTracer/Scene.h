@@ -5,6 +5,8 @@
 #include <RayTracer/SphereShape.h>
 #include <RayTracer/PlaneShape.h>
 #include <RayTracer/Light.h>
+#include <RayTracer/Profiler.h>
+#include <RayTracer/RayCapture.h>
 #include <RayTracer/Stats.h>
 #include <Math/Ray.h>
 #include <vector>
@@ -17,6 +19,8 @@ struct Scene
 
 	bool Hit(Intersection& intersection, const Ray& ray) const
 	{
+		PROFILE_SCOPE(Intersect);
+
 		++Stats::Rays;
 
 		float t = max_float_value;
@@ -36,7 +40,12 @@ struct Scene
 		}
 
 		if (!hit)
+		{
+			RayCapture::OnHit(ray, 0, 0);
 			return false;
+		}
+
+		RayCapture::OnHit(ray, t, RayCapture::Hit);
 
 		hit->PopulateIntersection(intersection, t, ray);
 
@@ -45,6 +54,8 @@ struct Scene
 
 	bool Hit(const Ray& ray) const
 	{
+		PROFILE_SCOPE(Shadow);
+
 		++Stats::Rays;
 
 		float t = max_float_value;
@@ -52,20 +63,30 @@ struct Scene
 		for (const auto& sphere : spheres)
 		{
 			if (sphere.Hit(t, ray))
+			{
+				RayCapture::OnHit(ray, 0, RayCapture::Occlusion | RayCapture::Hit);
 				return true;
+			}
 		}
 
 		for (const auto& plane : planes)
 		{
 			if (plane.Hit(t, ray))
+			{
+				RayCapture::OnHit(ray, 0, RayCapture::Occlusion | RayCapture::Hit);
 				return true;
+			}
 		}
 
+		RayCapture::OnHit(ray, 0, RayCapture::Occlusion);
+
 		return false;
 	}
 
 	float3 SampleEnvironment(const Ray& ray) const
 	{
+		PROFILE_SCOPE(Environment);
+
 		//unused(ray);
 		//return float3(8000);
 		return atmosphere.CalculateInscattering(ray.d) * atmosphere.sun.irradiance;
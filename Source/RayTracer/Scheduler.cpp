@@ -0,0 +1,206 @@
+#include <RayTracer/Scheduler.h>
+#include <RayTracer/Stats.h>
+#include <Core/Generic.h>
+#include <algorithm>
+
+namespace
+{
+	unsigned long THREAD_ENTRY WorkerMain(void* parameter)
+	{
+		Scheduler::Worker& worker = *static_cast<Scheduler::Worker*>(parameter);
+
+		worker.scheduler->Run(worker);
+
+		return 0;
+	}
+}
+
+bool Scheduler::Queue::Pop(int& task)
+{
+	ScopedLock lock(mutex);
+
+	if (head == tail)
+		return false;
+
+	task = head++;
+
+	return true;
+}
+
+bool Scheduler::Queue::Steal(int& task)
+{
+	ScopedLock lock(mutex);
+
+	if (head == tail)
+		return false;
+
+	task = --tail;
+
+	return true;
+}
+
+Scheduler::Scheduler(int worker_count) : worker_count(Clamp(worker_count, 1, max_worker_count))
+{
+	for (int i = 0; i < countof(workers); ++i)
+	{
+		workers[i].scheduler = this;
+		workers[i].index = i;
+	}
+}
+
+Scheduler::~Scheduler()
+{
+	Cancel();
+	Wait();
+}
+
+void Scheduler::Start(Allocator& allocator, Function function_, void* context_, const float* priorities, int count, int reserve)
+{
+	ASSERT(!IsRunning(), "Scheduler is already running");
+
+	function = function_;
+	context = context_;
+
+	// Sort the task indices so that the most important tasks come first. Ties are kept in
+	// submission order so that the caller's ordering (e.g. Morton order) is the fallback.
+
+	Array<int> sorted(allocator, count);
+
+	for (int i = 0; i < count; ++i)
+		sorted[i] = i;
+
+	std::stable_sort(sorted.values, sorted.values + count, [priorities](int a, int b) { return priorities[a] > priorities[b]; });
+
+	// Deal the tasks out round-robin so that every worker starts with a similar spread of
+	// priorities. Each worker owns a contiguous range of the shared task array, with its most
+	// important task at the front. The owner pops from the front and thieves take from the
+	// back, so the highest priority work is always done first and steals rarely contend.
+
+	tasks = Array<int>(allocator, count + reserve);
+
+	int offset = 0;
+
+	for (int w = 0; w < worker_count; ++w)
+	{
+		Queue& queue = workers[w].queue;
+
+		queue.head = offset;
+
+		for (int i = w; i < count; i += worker_count)
+			tasks[offset++] = sorted[i];
+
+		queue.tail = offset;
+	}
+
+	pushed.head = count;
+	pushed.tail = count;
+
+	cancelled = false;
+	running = worker_count;
+
+	for (int w = 0; w < worker_count; ++w)
+	{
+		workers[w].thread = Thread(WorkerMain, &workers[w]);
+		workers[w].thread.SetIdealProcessor(processor_offset + w);
+	}
+}
+
+bool Scheduler::Push(int first, int count)
+{
+	ScopedLock lock(pushed.mutex);
+
+	if (running == 0 || IsCancelled() || pushed.tail + count > tasks.count)
+		return false;
+
+	for (int i = 0; i < count; ++i)
+		tasks[pushed.tail++] = first + i;
+
+	return true;
+}
+
+void Scheduler::Cancel()
+{
+	cancelled = true;
+}
+
+bool Scheduler::Wait()
+{
+	for (int w = 0; w < worker_count; ++w)
+	{
+		if (!workers[w].thread.handle)
+			continue;
+
+		workers[w].thread.Join();
+		workers[w].thread = Thread();
+	}
+
+	tasks = Array<int>();
+
+	return !cancelled;
+}
+
+bool Scheduler::IsRunning() const
+{
+	return running > 0;
+}
+
+bool Scheduler::IsCancelled() const
+{
+	return cancelled.load(std::memory_order_relaxed);
+}
+
+void Scheduler::Run(Worker& worker)
+{
+	if (report_stats)
+		Stats::OnStartWorker(worker.index);
+
+	int completed = 0;
+	int steals = 0;
+
+	while (true)
+	{
+		int task;
+
+		if (!IsCancelled())
+		{
+			// Take pushed work first, then work from our own queue
+
+			if (pushed.Pop(task) || worker.queue.Pop(task))
+			{
+				function(context, tasks[task]);
+				completed++;
+				continue;
+			}
+
+			// Our queue is empty, so look for a victim, starting with our neighbor so that
+			// thieves spread out over the other workers.
+
+			bool stolen = false;
+
+			for (int i = 1; i < worker_count && !stolen; ++i)
+				stolen = workers[(worker.index + i) % worker_count].queue.Steal(task);
+
+			if (stolen)
+			{
+				function(context, tasks[task]);
+				completed++;
+				steals++;
+				continue;
+			}
+		}
+
+		// There's nothing left to steal, but tasks may have been pushed since we looked, so
+		// check again under the lock that Push takes before finishing.
+
+		ScopedLock lock(pushed.mutex);
+
+		if (IsCancelled() || pushed.head == pushed.tail)
+		{
+			running--;
+			break;
+		}
+	}
+
+	if (report_stats)
+		Stats::OnFinishWorker(worker.index, completed, steals);
+}
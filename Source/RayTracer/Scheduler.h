@@ -0,0 +1,132 @@
+#pragma once
+
+#include <System/Thread.h>
+#include <System/Mutex.h>
+#include <Core/Constants.h>
+#include <Core/Array.h>
+#include <atomic>
+
+struct Scheduler
+{
+	// Function run on a worker thread for each task
+	//
+	using Function = void(*)(void* context, int task);
+
+	struct Queue
+	{
+		// Remove the task at the front of the queue (called by the owning worker)
+		//
+		bool Pop(int& task);
+
+		// Remove the task at the back of the queue (called by other workers)
+		//
+		bool Steal(int& task);
+
+		// Protects the queue offsets
+		//
+		Mutex mutex;
+
+		// Offsets of the remaining tasks in the shared task array
+		//
+		int head = 0, tail = 0;
+	};
+
+	struct Worker
+	{
+		// Owning scheduler
+		//
+		Scheduler* scheduler = nullptr;
+
+		// Worker index
+		//
+		int index = 0;
+
+		// Tasks assigned to this worker in priority order
+		//
+		Queue queue;
+
+		// Native thread
+		//
+		Thread thread;
+	};
+
+	Scheduler(int worker_count);
+
+	Scheduler(const Scheduler&) = delete;
+	void operator=(const Scheduler&) = delete;
+
+	Scheduler(Scheduler&&) = delete;
+	void operator=(Scheduler&&) = delete;
+
+	~Scheduler();
+
+	// Sort the tasks by descending priority, deal them out to the worker queues and start the
+	// workers in the background. Room is kept for up to reserve more tasks to be pushed while
+	// the run is in progress.
+	//
+	void Start(Allocator& allocator, Function function, void* context, const float* priorities, int count, int reserve = 0);
+
+	// Add the tasks [first, first + count) to the current run, ahead of all the tasks still
+	// queued. Returns false if there are no workers left to run them or no room for them.
+	//
+	bool Push(int first, int count);
+
+	// Ask all workers to stop taking new tasks
+	//
+	void Cancel();
+
+	// Wait for all workers to finish. Returns false if the run was cancelled
+	//
+	bool Wait();
+
+	// Return true if there are workers still running
+	//
+	bool IsRunning() const;
+
+	// Return true if the current run has been cancelled
+	//
+	bool IsCancelled() const;
+
+	// Run tasks on the given worker until there is nothing left to run or steal
+	//
+	void Run(Worker& worker);
+
+	// Task function and context for the current run
+	//
+	Function function = nullptr;
+	void* context = nullptr;
+
+	// Task indices for all worker queues, followed by the pushed tasks
+	//
+	Array<int> tasks;
+
+	// Tasks pushed during the run, which every worker takes before its own queue. Its lock
+	// also guards workers finishing, so that a push never arrives after the last one has gone.
+	//
+	Queue pushed;
+
+	// Worker state
+	//
+	Worker workers[max_worker_count];
+
+	// Number of workers
+	//
+	int worker_count = 0;
+
+	// Processor the first worker is pinned to, with the others on the processors after it
+	//
+	int processor_offset = 0;
+
+	// Report the workers of each run to the render stats and profiler. Runs that aren't part of
+	// a render turn this off so that they don't show up in its stats.
+	//
+	bool report_stats = true;
+
+	// Number of workers that haven't finished the current run
+	//
+	std::atomic<int> running = { 0 };
+
+	// Set when the current run should stop early
+	//
+	std::atomic<bool> cancelled = { false };
+};
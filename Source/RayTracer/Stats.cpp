@@ -1,42 +1,132 @@
 #include <RayTracer/Stats.h>
+#include <RayTracer/Profiler.h>
+#include <RayTracer/RayCapture.h>
 #include <System/Time.h>
+#include <Core/Generic.h>
+#include <Core/Memory.h>
+#include <Core/String.h>
 #include <Core/Log.h>
 
 uint64_t Stats::Start = 0;
 uint64_t Stats::Finish = 0;
 uint64_t Stats::TotalRays = 0;
 
+Stats::PathStats Stats::TotalPaths;
+
 int Stats::Quality = 0;
 int Stats::Width = 0;
 int Stats::Height = 0;
+int Stats::WorkerCount = 0;
+
+Stats::WorkerStats Stats::Workers[max_worker_count];
 
 thread_local uint64_t Stats::Rays = 0;
+thread_local Stats::PathStats Stats::Paths;
 
-void Stats::OnStartRender(int w, int h, int quality)
+namespace
 {
-	#pragma omp parallel
+	void Accumulate(Stats::PathStats& total, const Stats::PathStats& paths)
 	{
-		Rays = 0;
+		for (int i = 0; i <= Stats::max_bounce_bucket; ++i)
+			total.bounces[i] += paths.bounces[i];
+
+		for (int i = 0; i < int(Stats::PathEnd::Count); ++i)
+			total.ends[i] += paths.ends[i];
+
+		total.total_bounces += paths.total_bounces;
 	}
 
+	void LogPaths(const Stats::PathStats& paths)
+	{
+		uint64_t count = 0;
+
+		for (uint64_t ends : paths.ends)
+			count += ends;
+
+		if (count == 0)
+			return;
+
+		const double scale = 100.0 / count;
+
+		LOG_INFO("Paths: %llu, bounces = %.2f mean, escaped = %.1f%%, roulette = %.1f%%, max depth = %.1f%%", count, paths.total_bounces / double(count), paths.ends[int(Stats::PathEnd::Escaped)] * scale, paths.ends[int(Stats::PathEnd::Roulette)] * scale, paths.ends[int(Stats::PathEnd::MaxDepth)] * scale);
+
+		// List the bounce counts up to the longest path, as a share of all the paths
+
+		int longest = Stats::max_bounce_bucket;
+		while (longest > 0 && paths.bounces[longest] == 0)
+			--longest;
+
+		char line[512];
+		size_t length = 0;
+
+		for (int i = 0; i <= longest; ++i)
+			length += String::Format(line + length, sizeof(line) - length, " %i%s: %.1f%%", i, i == Stats::max_bounce_bucket ? "+" : "", paths.bounces[i] * scale);
+
+		LOG_INFO("  Bounces:%s", line);
+	}
+}
+
+void Stats::OnStartRender(int w, int h, int quality, int workers)
+{
 	Start = Time::Now();
 	Finish = Start;
 	Width = w;
 	Height = h;
 	Quality = quality;
+	WorkerCount = workers;
+
+	for (int i = 0; i < workers; ++i)
+		Workers[i] = WorkerStats();
 
 	TotalRays = 0;
+	TotalPaths = PathStats();
+
+	Profiler::OnStartRender(workers);
+	RayCapture::OnStartRender(workers);
 }
 
 void Stats::OnFinishRender()
 {
-	Finish = Time::Now();
+	// The render is finished when the last worker runs out of work. Any time before that
+	// when a worker has nothing to do is counted as idle time for that worker.
 
-	#pragma omp parallel
+	for (int i = 0; i < WorkerCount; ++i)
 	{
-		#pragma omp atomic
-		TotalRays += Rays;
+		Finish = Max(Finish, Workers[i].finish);
+		TotalRays += Workers[i].rays;
+
+		Accumulate(TotalPaths, Workers[i].paths);
 	}
+
+	Profiler::OnFinishRender();
+}
+
+void Stats::OnStartWorker(int worker)
+{
+	Rays = 0;
+	Paths = PathStats();
+
+	Profiler::OnStartWorker(worker);
+	RayCapture::OnStartWorker(worker);
+}
+
+void Stats::OnFinishWorker(int worker, int tasks, int steals)
+{
+	Workers[worker].rays = Rays;
+	Workers[worker].finish = Time::Now();
+	Workers[worker].tasks = tasks;
+	Workers[worker].steals = steals;
+	Workers[worker].paths = Paths;
+
+	Profiler::OnFinishWorker(worker);
+	RayCapture::OnFinishWorker(worker);
+}
+
+double Stats::GetRaysPerSecond()
+{
+	const float duration = Time::Elapsed(Start, Finish);
+
+	return duration > 0 ? TotalRays / double(duration) : 0.0;
 }
 
 void Stats::Log()
@@ -44,4 +134,27 @@ void Stats::Log()
 	const float duration = Time::Elapsed(Start, Finish);
 
 	LOG_INFO("Render (%i x %i): quality = %i, rays = %llu, duration = %.2f s, efficiency = %.2f Mray/s", Width, Height, Quality, TotalRays, duration, (TotalRays * 0.000001f) / duration);
+
+	int steals = 0;
+	float idle = 0;
+
+	for (int i = 0; i < WorkerCount; ++i)
+	{
+		const WorkerStats& worker = Workers[i];
+
+		const float worker_idle = Time::Elapsed(worker.finish, Finish);
+
+		LOG_INFO("  Worker %2i: tasks = %4i, steals = %3i, idle = %.1f ms", i, worker.tasks, worker.steals, worker_idle * 1000);
+
+		steals += worker.steals;
+		idle += worker_idle;
+	}
+
+	LOG_INFO("Workers: %i, steals = %i, idle = %.1f%%", WorkerCount, steals, WorkerCount > 0 ? 100 * idle / (duration * WorkerCount) : 0.0f);
+
+	LogPaths(TotalPaths);
+
+	Profiler::Log();
+
+	Memory::LogReport();
 }
@@ -1,17 +1,82 @@
 #pragma once
 
+#include <Core/Constants.h>
 #include <Core/Types.h>
 
 namespace Stats
 {
+	// Paths are counted by their number of bounces up to this, with longer paths counted together
+	//
+	constexpr int max_bounce_bucket = 16;
+
+	// Why a path stopped bouncing
+	//
+	enum class PathEnd
+	{
+		Escaped,
+		Roulette,
+		MaxDepth,
+		Count
+	};
+
+	struct PathStats
+	{
+		// Number of paths ending after each number of surface bounces
+		//
+		uint64_t bounces[max_bounce_bucket + 1] = {};
+
+		// Number of paths ending for each reason
+		//
+		uint64_t ends[int(PathEnd::Count)] = {};
+
+		// Total surface bounces over all the paths
+		//
+		uint64_t total_bounces = 0;
+	};
+
+	struct WorkerStats
+	{
+		// Number of rays cast by the worker
+		//
+		uint64_t rays = 0;
+
+		// Time at which the worker ran out of work
+		//
+		uint64_t finish = 0;
+
+		// Number of tasks completed, including stolen ones
+		//
+		int tasks = 0;
+
+		// Number of tasks stolen from other workers
+		//
+		int steals = 0;
+
+		// Lengths of the paths traced by the worker
+		//
+		PathStats paths;
+	};
+
 	// Notify that a render will start
 	//
-	void OnStartRender(int w, int h, int quality);
+	void OnStartRender(int w, int h, int quality, int workers);
 
 	// Notify that a render has completed
 	//
 	void OnFinishRender();
 
+	// Notify that a worker thread is starting on the current render
+	//
+	void OnStartWorker(int worker);
+
+	// Notify that a worker thread has run out of work for the current render
+	//
+	void OnFinishWorker(int worker, int tasks, int steals);
+
+	// Notify that a path traced on the current thread has ended after a number of bounces
+	//
+	inline void OnPathEnd(int bounces, PathEnd end);
+
 	// Start and finish render times
 	//
 	extern uint64_t Start;
@@ -34,7 +99,31 @@ namespace Stats
 	//
 	extern thread_local uint64_t Rays;
 
+	// Lengths of the paths traced in total, and on a particular thread
+	//
+	extern PathStats TotalPaths;
+	extern thread_local PathStats Paths;
+
+	// Number of workers used for the last render
+	//
+	extern int WorkerCount;
+
+	// Per-worker stats for the last render
+	//
+	extern WorkerStats Workers[max_worker_count];
+
+	// Return the ray throughput of the last completed render in rays per second
+	//
+	double GetRaysPerSecond();
+
 	// Log all stats after a run has completed
 	//
 	void Log();
 }
+
+inline void Stats::OnPathEnd(int bounces, PathEnd end)
+{
+	++Paths.bounces[bounces < max_bounce_bucket ? bounces : max_bounce_bucket];
+	++Paths.ends[int(end)];
+	Paths.total_bounces += bounces;
+}
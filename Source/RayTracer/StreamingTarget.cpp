@@ -0,0 +1,226 @@
+#include <RayTracer/StreamingTarget.h>
+#include <System/Time.h>
+#include <Core/Generic.h>
+#include <Core/Memory.h>
+#include <Core/String.h>
+#include <Core/Log.h>
+
+namespace
+{
+	unsigned long THREAD_ENTRY WriterMain(void* parameter)
+	{
+		static_cast<StreamingTarget*>(parameter)->WriteQueued();
+
+		return 0;
+	}
+}
+
+StreamingTarget::StreamingTarget(Allocator& allocator, int w, int h, int tile_size, int block_count, float exposure) :
+	w(w),
+	h(h),
+	tile_size(tile_size),
+	exposure(exposure),
+	queued_tiles(allocator, block_count),
+	queued_blocks(allocator, block_count),
+	free_blocks(allocator, block_count),
+	tile_queued(nullptr, 1),
+	block_freed(nullptr, 1),
+	free_count(block_count)
+{
+	Memory::TagScope tag(Memory::Tag::Framebuffers);
+
+	texels = Array<float3>(allocator, block_count * tile_size * tile_size);
+
+	for (int i = 0; i < block_count; ++i)
+		free_blocks[i] = i;
+}
+
+StreamingTarget::~StreamingTarget()
+{
+	if (thread.handle)
+		Close();
+}
+
+int StreamingTarget::GetWidth() const
+{
+	return w;
+}
+
+int StreamingTarget::GetHeight() const
+{
+	return h;
+}
+
+bool StreamingTarget::Open(const char* path)
+{
+	if (!file.OpenForStreaming(path))
+	{
+		LOG_ERROR("Failed to save image to %s", path);
+		return false;
+	}
+
+	// Same layout as Pfm::SaveImage, with the texels following the header immediately
+
+	char header[64];
+
+	header_size = String::Format(header, sizeof(header), "PF\n%i\n%i\n-1.0\n", w, h);
+
+	if (!file.WriteAt(0, header, header_size))
+		return false;
+
+	closing = false;
+
+	thread = Thread(WriterMain, this);
+
+	return true;
+}
+
+void StreamingTarget::WriteTile(Tile tile, const float3* radiance)
+{
+	// Wait for a free block if the writer is behind
+
+	int block = -1;
+	bool more = false;
+
+	while (block < 0)
+	{
+		{
+			ScopedLock lock(mutex);
+
+			if (free_count > 0)
+				block = free_blocks[--free_count];
+			else
+				++stalls;
+
+			more = free_count > 0;
+		}
+
+		if (block < 0)
+			block_freed.Wait();
+	}
+
+	// Several blocks may have been freed while only one waiting worker was woken, so pass the
+	// wake up on to the next one
+
+	if (more)
+		block_freed.Raise();
+
+	float3* values = &texels[block * tile_size * tile_size];
+
+	for (int i = 0; i < tile.w * tile.h; ++i)
+		values[i] = radiance[i] * exposure;
+
+	{
+		ScopedLock lock(mutex);
+
+		const int i = (queue_head + queue_count) % queued_tiles.count;
+
+		queued_tiles[i] = tile;
+		queued_blocks[i] = block;
+
+		peak_queued = Max(peak_queued, ++queue_count);
+	}
+
+	tile_queued.Raise();
+}
+
+void StreamingTarget::WriteQueued()
+{
+	for (;;)
+	{
+		Tile tile;
+		int block = -1;
+
+		{
+			ScopedLock lock(mutex);
+
+			if (queue_count > 0)
+			{
+				tile = queued_tiles[queue_head];
+				block = queued_blocks[queue_head];
+
+				queue_head = (queue_head + 1) % queued_tiles.count;
+				--queue_count;
+			}
+			else if (closing)
+				return;
+		}
+
+		if (block < 0)
+		{
+			tile_queued.Wait();
+			continue;
+		}
+
+		// Rows of the tile are contiguous in the file when it spans the whole width
+
+		const float3* values = &texels[block * tile_size * tile_size];
+
+		bool success = true;
+
+		if (tile.w == w)
+		{
+			success = file.WriteAt(header_size + sizeof(float3) * uint64_t(w) * tile.y, values, sizeof(float3) * tile.w * tile.h);
+		}
+		else
+		{
+			for (int y = 0; y < tile.h && success; ++y)
+			{
+				const uint64_t offset = header_size + sizeof(float3) * (uint64_t(w) * (tile.y + y) + tile.x);
+
+				success = file.WriteAt(offset, values + y * tile.w, sizeof(float3) * tile.w);
+			}
+		}
+
+		{
+			ScopedLock lock(mutex);
+
+			free_blocks[free_count++] = block;
+
+			++written;
+
+			failed |= !success;
+		}
+
+		block_freed.Raise();
+	}
+}
+
+bool StreamingTarget::Close()
+{
+	const uint64_t start = Time::Now();
+
+	{
+		ScopedLock lock(mutex);
+
+		closing = true;
+	}
+
+	if (thread.handle)
+	{
+		tile_queued.Raise();
+
+		thread.Join();
+		thread = Thread();
+	}
+
+	file.Close();
+
+	if (failed)
+	{
+		LOG_ERROR("Failed to write part of the image");
+		return false;
+	}
+
+	const int tile_count = ((w + tile_size - 1) / tile_size) * ((h + tile_size - 1) / tile_size);
+
+	if (written != tile_count)
+	{
+		LOG_ERROR("Only %i of %i tiles of the image were rendered", written, tile_count);
+		return false;
+	}
+
+	LOG_INFO("Streamed %i tiles through %i blocks (%.1f MiB), at most %i queued, %i stalls, %.1f ms to flush", written, free_blocks.count, texels.count * sizeof(float3) / (1024.0f * 1024.0f), peak_queued, stalls, Time::Elapsed(start, Time::Now()) * 1000);
+
+	return true;
+}
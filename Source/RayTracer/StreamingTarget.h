@@ -0,0 +1,108 @@
+#pragma once
+
+#include <RayTracer/RenderTarget.h>
+#include <System/Semaphore.h>
+#include <System/Thread.h>
+#include <System/File.h>
+#include <System/Mutex.h>
+#include <Core/Array.h>
+
+// Writes exposed radiance straight to a .pfm file as tiles finish, so that frames far larger
+// than memory can be rendered. Finished tiles are copied into one of a fixed pool of blocks
+// and a background thread writes their rows into place in the file, in whatever order they
+// arrive. Memory use depends on the number of blocks rather than on the resolution, and
+// workers wait for a free block if the writer falls behind.
+//
+struct StreamingTarget : RenderTarget
+{
+	StreamingTarget(Allocator& allocator, int w, int h, int tile_size, int block_count, float exposure);
+
+	StreamingTarget(const StreamingTarget&) = delete;
+	void operator=(const StreamingTarget&) = delete;
+
+	~StreamingTarget();
+
+	int GetWidth() const override;
+	int GetHeight() const override;
+
+	void WriteTile(Tile tile, const float3* radiance) override;
+
+	// Create the file, write the header and start the writer thread
+	//
+	bool Open(const char* path);
+
+	// Write the remaining tiles and close the file, failing if any tile wasn't written
+	//
+	bool Close();
+
+	// Write tiles from the queue until closed (called on the writer thread)
+	//
+	void WriteQueued();
+
+	// Output file
+	//
+	File file;
+
+	// Size of the .pfm header before the texels
+	//
+	size_t header_size = 0;
+
+	// Dimensions in pixels
+	//
+	int w = 0;
+	int h = 0;
+
+	// Tile size in pixels, which is also the size of each block
+	//
+	int tile_size = 1;
+
+	// Exposure applied to the radiance before it's written
+	//
+	float exposure = 1;
+
+	// Radiance for each block, stored contiguously as tile.w x tile.h values
+	//
+	Array<float3> texels;
+
+	// Tiles waiting to be written, and the block holding each one
+	//
+	Array<Tile> queued_tiles;
+	Array<int> queued_blocks;
+
+	// Blocks not holding a tile
+	//
+	Array<int> free_blocks;
+
+	// Guards everything below
+	//
+	Mutex mutex;
+
+	// Raised when a tile is queued, and when a block is freed
+	//
+	Semaphore tile_queued;
+	Semaphore block_freed;
+
+	// Writer thread
+	//
+	Thread thread;
+
+	// Ring buffer offset and count of the queued tiles, and count of free blocks
+	//
+	int queue_head = 0;
+	int queue_count = 0;
+	int free_count = 0;
+
+	// Most tiles queued at once, and number of times a worker had to wait for a block
+	//
+	int peak_queued = 0;
+	int stalls = 0;
+
+	// Number of tiles written, and true if any write failed
+	//
+	int written = 0;
+	bool failed = false;
+
+	// Set to stop the writer once the queue is empty
+	//
+	bool closing = false;
+};
@@ -0,0 +1,102 @@
+#include <RayTracer/Integrator/PathIntegrator.h>
+#include <RayTracer/Texture/ConstantTexture.h>
+#include <RayTracer/Material.h>
+#include <RayTracer/Sampler.h>
+#include <RayTracer/Scene.h>
+#include <RayTracer/Stats.h>
+#include <Math/Random.h>
+#include <Math/Ray.h>
+#include <UnitTest++/UnitTest++.h>
+#include <cmath>
+
+namespace
+{
+	// Paths traced with and without roulette
+	//
+	constexpr int path_count = 20000;
+
+	// Floor and four walls around the origin, lit from straight above. The light direction is
+	// parallel to the walls, so nothing shadows the floor, and every other direction out of the
+	// box hits a wall, so no path escapes and only roulette or the max depth can end it.
+	//
+	struct ClosedBox
+	{
+		ClosedBox() : material(flat_normal, grey, rough, zero)
+		{
+			scene.planes.push_back({ { 0, 0, 0 }, { 0, 1, 0 }, material });
+			scene.planes.push_back({ { -2, 0, 0 }, { 1, 0, 0 }, material });
+			scene.planes.push_back({ { +2, 0, 0 }, { -1, 0, 0 }, material });
+			scene.planes.push_back({ { 0, 0, -2 }, { 0, 0, 1 }, material });
+			scene.planes.push_back({ { 0, 0, +2 }, { 0, 0, -1 }, material });
+			scene.lights.push_back({ { 0, 1, 0 }, { 3, 3, 3 } });
+		}
+
+		ConstantTexture<float3> flat_normal = { { 0.5f, 0.5f, 1.0f } };
+		ConstantTexture<float3> grey = { { 0.8f, 0.8f, 0.8f } };
+		ConstantTexture<float> rough = { 1.0f };
+		ConstantTexture<float> zero = { 0.0f };
+
+		Material material;
+		Scene scene;
+	};
+
+	// Radiance along the path for sample i, summed over the channels. The sampler and the random
+	// stream are seeded from i, so both integrators trace the same camera ray and bounce the
+	// same way up to where roulette first ends a path.
+	//
+	double Trace(const PathIntegrator& integrator, const Scene& scene, int i)
+	{
+		XorShiftRandomSampler sampler(1);
+
+		sampler.StartPixel(i % 256, i / 256);
+		sampler.StartSample();
+
+		Random::SetSeed(i);
+
+		const float3 radiance = integrator.Li(sampler, Ray({ 0, 1, 0 }, Random::PointOnSphere()), scene);
+
+		return double(radiance.x) + radiance.y + radiance.z;
+	}
+}
+
+SUITE(PathIntegrator)
+{
+	TEST(RouletteKeepsTheMeanRadiance)
+	{
+		const ClosedBox box;
+
+		// Roulette from the first bounce, with a threshold high enough that most paths are ended
+		// well before the max depth
+
+		const PathIntegrator full(8, 0, 0.0f);
+		const PathIntegrator roulette(8, 1, 1.0f);
+
+		const uint64_t ended = Stats::Paths.ends[int(Stats::PathEnd::Roulette)];
+
+		// Compare the paired samples, which vary much less between the two than either does
+		// on its own
+
+		double sum = 0;
+		double sum_differences = 0;
+		double sum_squared_differences = 0;
+
+		for (int i = 0; i < path_count; ++i)
+		{
+			const double a = Trace(full, box.scene, i);
+			const double b = Trace(roulette, box.scene, i);
+
+			sum += a;
+			sum_differences += b - a;
+			sum_squared_differences += (b - a) * (b - a);
+		}
+
+		const double mean = sum / path_count;
+		const double mean_difference = sum_differences / path_count;
+		const double variance = (sum_squared_differences - sum_differences * mean_difference) / (path_count - 1);
+		const double standard_error = sqrt(variance / path_count);
+
+		CHECK(mean > 0);
+		CHECK(Stats::Paths.ends[int(Stats::PathEnd::Roulette)] - ended > uint64_t(path_count / 2));
+		CHECK(fabs(mean_difference) < 4 * standard_error);
+	}
+}
@@ -0,0 +1,155 @@
+#include <RayTracer/ToneMap.h>
+#include <Image/Srgb.h>
+#include <Math/Random.h>
+#include <Core/Constants.h>
+#include <Core/Generic.h>
+#include <UnitTest++/UnitTest++.h>
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+	// Samples taken across each bucket of the encode table, including both of its edges
+	//
+	constexpr int samples_per_bucket = 64;
+
+	// Nearest 8-bit code for a linear value, evaluated in double precision with pow
+	//
+	int EncodeExact(float linear)
+	{
+		const double x = linear;
+		const double gamma = x <= 0.0031308 ? x * 12.92 : 1.055 * pow(x, 1 / 2.4) - 0.055;
+
+		return int(gamma * 255 + 0.5);
+	}
+
+	// Linear values at every sample across the encode table buckets, with the values one ulp
+	// either side of each bucket edge
+	//
+	template<typename F>
+	void ForEachBucketSample(F f)
+	{
+		const int bucket_count = Srgb::encode_table_size - 1;
+
+		for (int i = 0; i <= bucket_count * samples_per_bucket; ++i)
+			f(float(double(i) / (bucket_count * samples_per_bucket)));
+
+		for (int i = 0; i < bucket_count; ++i)
+		{
+			const float edge = float((i + 0.5) / bucket_count);
+
+			f(nextafterf(edge, 0.0f));
+			f(edge);
+			f(nextafterf(edge, 1.0f));
+		}
+	}
+
+	bool operator==(const Bgra& lhs, const Bgra& rhs)
+	{
+		return lhs.b == rhs.b && lhs.g == rhs.g && lhs.r == rhs.r && lhs.a == rhs.a;
+	}
+}
+
+SUITE(ToneMap)
+{
+	TEST(EncodeTableWithinOneCode)
+	{
+		int worst = 0;
+
+		ForEachBucketSample([&](float linear)
+		{
+			worst = Max(worst, abs(int(Srgb::FromLinear(linear)) - EncodeExact(linear)));
+		});
+
+		CHECK(worst <= 1);
+	}
+
+	TEST(VectorEncodeWithinOneCode)
+	{
+		// With the clamp curve and unit exposure the radiance goes straight to the encoding, so
+		// this checks the vector kernel's quantization against the exact encoding
+
+		constexpr int row_size = 1024;
+
+		float3 radiance[row_size];
+		Bgra texels[row_size];
+
+		const ToneMap::Settings settings = { 1.0f, ToneMap::Curve::Clamp };
+
+		int count = 0;
+		int worst = 0;
+
+		const auto flush = [&]()
+		{
+			ToneMap::ToDisplay(texels, radiance, count, settings);
+
+			for (int i = 0; i < count; ++i)
+			{
+				const int exact = EncodeExact(radiance[i].r);
+
+				worst = Max(worst, abs(int(texels[i].r) - exact));
+				worst = Max(worst, abs(int(texels[i].g) - exact));
+				worst = Max(worst, abs(int(texels[i].b) - exact));
+			}
+
+			count = 0;
+		};
+
+		ForEachBucketSample([&](float linear)
+		{
+			radiance[count++] = { linear, linear, linear };
+
+			if (count == row_size)
+				flush();
+		});
+
+		flush();
+
+		CHECK(worst <= 1);
+	}
+
+	TEST(VectorMatchesScalar)
+	{
+		// Include the values that the kernel has to handle specially, then fill the row with
+		// radiance over a wide range. The row length isn't a multiple of four so the tail is
+		// covered too.
+
+		constexpr int row_size = 4099;
+
+		float3 radiance[row_size];
+		Bgra texels[row_size];
+
+		const float specials[] = { 0.0f, -0.0f, -1.0f, 1.0f, 1.0e+4f, 1.0e+30f, infinity, -infinity, NAN };
+
+		Random::SetSeed(0x70e);
+
+		for (int i = 0; i < row_size; ++i)
+		{
+			for (float& channel : radiance[i].values)
+				channel = i < 3 * countof(specials) ? specials[Random::Integer(0, countof(specials))] : powf(10.0f, Random::Real() * 8 - 5);
+		}
+
+		const ToneMap::Curve curves[] = { ToneMap::Curve::Aces, ToneMap::Curve::Clamp };
+		const float exposures[] = { 1.0f, 0.01f, 37.5f };
+
+		for (ToneMap::Curve curve : curves)
+		{
+			for (float exposure : exposures)
+			{
+				const ToneMap::Settings settings = { exposure, curve };
+
+				ToneMap::ToDisplay(texels, radiance, row_size, settings);
+
+				int mismatches = 0;
+
+				for (int i = 0; i < row_size; ++i)
+				{
+					if (!(texels[i] == ToneMap::ToDisplay(radiance[i], settings)))
+						++mismatches;
+				}
+
+				CHECK_EQUAL(0, mismatches);
+			}
+		}
+	}
+}
@@ -4,6 +4,7 @@
 #include <Image/Image.h>
 #include <Image/Tga.h>
 #include <Core/Generic.h>
+#include <Core/Memory.h>
 
 struct LinearValue
 {
@@ -43,6 +44,8 @@ struct ImageTexture : Texture<typename T::Decompressed>
 {
 	ImageTexture(Allocator& allocator, const char* path)
 	{
+		Memory::TagScope tag(Memory::Tag::Textures);
+
 		const bool loaded = Tga::LoadImage(image, allocator, path);
 
 		CRITICAL(loaded, "Image not loaded");
@@ -5,14 +5,14 @@
 
 RowTiler::RowTiler(Allocator& allocator, int w, int h, int size) : Tiler(allocator, w, h, size)
 {
-	for (uint16_t i = 0; i < count; ++i)
-		tiles[i] = i;
+	for (int i = 0; i < count; ++i)
+		tiles[i] = uint32_t(i);
 }
 
 RandomTiler::RandomTiler(Allocator& allocator, int w, int h, int size) : Tiler(allocator, w, h, size)
 {
-	for (uint16_t i = 0; i < count; ++i)
-		tiles[i] = i;
+	for (int i = 0; i < count; ++i)
+		tiles[i] = uint32_t(i);
 
 	for (int i = 0; i < count; ++i)
 		Swap(tiles[i], tiles[Random::Integer(i, count)]);
@@ -29,6 +29,24 @@ MortonTiler::MortonTiler(Allocator& allocator, int w, int h, int size) : Tiler(a
 		MortonCode::Decode(x, y, code++);
 
 		if (x < tiles.w && y < tiles.h)
-			tiles[index++] = uint16_t(y * tiles.w + x);
+			tiles[index++] = uint32_t(y * tiles.w + x);
 	}
 }
+
+float RowPriority::Evaluate(Tile tile) const
+{
+	return -float(tile.y);
+}
+
+float CenterPriority::Evaluate(Tile tile) const
+{
+	const float dx = tile.x + 0.5f * tile.w - cx;
+	const float dy = tile.y + 0.5f * tile.h - cy;
+
+	return -Length(float2(dx, dy));
+}
+
+float ErrorPriority::Evaluate(Tile tile) const
+{
+	return errors(tile.x / size, tile.y / size);
+}
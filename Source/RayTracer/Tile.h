@@ -8,6 +8,32 @@ struct Tile
 	Tile() = default;
 	Tile(int x, int y, int w, int h) : x(x), y(y), w(w), h(h) {}
 
+	// Clip the tile to an image of the given dimensions
+	//
+	Tile Clip(int iw, int ih) const
+	{
+		return { x, y, w < iw - x ? w : iw - x, h < ih - y ? h : ih - y };
+	}
+
+	// Return the overlap with another tile, which is empty if they don't overlap
+	//
+	Tile Intersect(Tile other) const
+	{
+		const int x0 = x > other.x ? x : other.x;
+		const int y0 = y > other.y ? y : other.y;
+		const int x1 = x + w < other.x + other.w ? x + w : other.x + other.w;
+		const int y1 = y + h < other.y + other.h ? y + h : other.y + other.h;
+
+		return { x0, y0, x1 > x0 ? x1 - x0 : 0, y1 > y0 ? y1 - y0 : 0 };
+	}
+
+	// Return true if the tile covers no pixels
+	//
+	bool IsEmpty() const
+	{
+		return w <= 0 || h <= 0;
+	}
+
 	int x = 0;
 	int y = 0;
 	int w = 0;
@@ -16,6 +42,7 @@ struct Tile
 
 struct Tiler
 {
+	Tiler() = default;
 	Tiler(Allocator& allocator, int w, int h, int size) : tiles(allocator, (w + size - 1) / size, (h + size - 1) / size), size(size), count(tiles.w * tiles.h)
 	{
 	}
@@ -34,7 +61,7 @@ struct Tiler
 
 	// Tile indices
 	//
-	Image<uint16_t> tiles;
+	Image<uint32_t> tiles;
 
 	// Tile size in pixels
 	//
@@ -59,3 +86,50 @@ struct MortonTiler : Tiler
 {
 	MortonTiler(Allocator& allocator, int w, int h, int size);
 };
+
+struct TilePriority
+{
+	virtual ~TilePriority() = default;
+
+	// Return the priority of the tile. Higher priority tiles are rendered first
+	//
+	virtual float Evaluate(Tile tile) const = 0;
+};
+
+struct CenterPriority : TilePriority
+{
+	CenterPriority(int w, int h) : cx(0.5f * w), cy(0.5f * h) {}
+
+	// Tiles closest to the center of the screen come first
+	//
+	float Evaluate(Tile tile) const override;
+
+	// Screen center in pixels
+	//
+	float cx = 0;
+	float cy = 0;
+};
+
+struct RowPriority : TilePriority
+{
+	// Rows of tiles come first from top to bottom, so that they finish in order
+	//
+	float Evaluate(Tile tile) const override;
+};
+
+struct ErrorPriority : TilePriority
+{
+	ErrorPriority(const Image<float>& errors, int size) : errors(errors), size(size) {}
+
+	// Tiles with the highest estimated error from the previous render come first
+	//
+	float Evaluate(Tile tile) const override;
+
+	// Mean error estimate for each tile
+	//
+	const Image<float>& errors;
+
+	// Tile size in pixels
+	//
+	int size = 1;
+};
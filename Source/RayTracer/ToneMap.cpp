@@ -0,0 +1,108 @@
+#include <RayTracer/ToneMap.h>
+#include <Image/Srgb.h>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define TONEMAP_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	// Exposed radiance is clamped to this before the curve so that infinities come out white
+	// rather than NaN
+	//
+	constexpr float max_exposed = 1.0e+4f;
+
+	// Per-channel tone curve. The vector kernel below performs exactly the same operations in
+	// the same order, so both produce identical codes.
+	//
+	float ApplyCurve(float x, ToneMap::Curve curve)
+	{
+		x = x > 0 ? (x < max_exposed ? x : max_exposed) : 0;
+
+		if (curve == ToneMap::Curve::Aces)
+			x = (x * (2.51f * x + 0.03f)) / (x * (2.43f * x + 0.59f) + 0.14f);
+
+		return x < 1 ? x : 1;
+	}
+}
+
+float3 ToneMap::Apply(float3 radiance, const Settings& settings)
+{
+	const float3 x = radiance * settings.exposure;
+
+	return { ApplyCurve(x.r, settings.curve), ApplyCurve(x.g, settings.curve), ApplyCurve(x.b, settings.curve) };
+}
+
+Bgra ToneMap::ToDisplay(float3 radiance, const Settings& settings)
+{
+	const float3 t = Apply(radiance, settings);
+
+	return { Srgb::FromLinear(t.b), Srgb::FromLinear(t.g), Srgb::FromLinear(t.r) };
+}
+
+#ifdef TONEMAP_SSE2
+
+void ToneMap::ToDisplay(Bgra* texels, const float3* radiance, int count, const Settings& settings)
+{
+	static_assert(sizeof(float3) == 3 * sizeof(float), "Radiance rows are processed as packed floats");
+
+	// The curve and the sRGB encoding are applied per channel, so four pixels are handled as
+	// three vectors of packed rgb floats and only the final lookup needs to know the layout.
+
+	const float* values = &radiance[0].x;
+	const uint8_t* table = Srgb::GetEncodeTable();
+
+	const bool aces = settings.curve == Curve::Aces;
+
+	const __m128 exposure = _mm_set1_ps(settings.exposure);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 limit = _mm_set1_ps(max_exposed);
+	const __m128 a = _mm_set1_ps(2.51f);
+	const __m128 b = _mm_set1_ps(0.03f);
+	const __m128 c = _mm_set1_ps(2.43f);
+	const __m128 d = _mm_set1_ps(0.59f);
+	const __m128 e = _mm_set1_ps(0.14f);
+	const __m128 scale = _mm_set1_ps(float(Srgb::encode_table_size - 1));
+	const __m128 half = _mm_set1_ps(0.5f);
+
+	int i = 0;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		alignas(16) int32_t codes[12];
+
+		for (int j = 0; j < 3; ++j)
+		{
+			__m128 x = _mm_mul_ps(_mm_loadu_ps(values + 3 * i + 4 * j), exposure);
+
+			// Operand order matters here, _mm_max_ps returns the second operand for NaN
+
+			x = _mm_min_ps(_mm_max_ps(x, zero), limit);
+
+			if (aces)
+				x = _mm_div_ps(_mm_mul_ps(x, _mm_add_ps(_mm_mul_ps(a, x), b)), _mm_add_ps(_mm_mul_ps(x, _mm_add_ps(_mm_mul_ps(c, x), d)), e));
+
+			x = _mm_min_ps(x, one);
+
+			_mm_store_si128(reinterpret_cast<__m128i*>(codes + 4 * j), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(x, scale), half)));
+		}
+
+		for (int k = 0; k < 4; ++k)
+			texels[i + k] = { table[codes[3 * k + 2]], table[codes[3 * k + 1]], table[codes[3 * k + 0]] };
+	}
+
+	for (; i < count; ++i)
+		texels[i] = ToDisplay(radiance[i], settings);
+}
+
+#else
+
+void ToneMap::ToDisplay(Bgra* texels, const float3* radiance, int count, const Settings& settings)
+{
+	for (int i = 0; i < count; ++i)
+		texels[i] = ToDisplay(radiance[i], settings);
+}
+
+#endif
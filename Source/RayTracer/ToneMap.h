@@ -0,0 +1,36 @@
+#pragma once
+
+#include <Image/Texel.h>
+#include <Math/Vector.h>
+
+namespace ToneMap
+{
+	enum class Curve
+	{
+		Aces,
+		Clamp
+	};
+
+	struct Settings
+	{
+		// Exposure scale applied to radiance before the curve (usually Camera::exposure)
+		//
+		float exposure = 1;
+
+		// Tone curve
+		//
+		Curve curve = Curve::Aces;
+	};
+
+	// Expose and tone map radiance to [0, 1]. The ACES curve is the Narkowicz fit
+	//
+	float3 Apply(float3 radiance, const Settings& settings);
+
+	// Expose, tone map, gamma encode and quantize radiance to a display texel
+	//
+	Bgra ToDisplay(float3 radiance, const Settings& settings);
+
+	// Expose, tone map, gamma encode and quantize a row of radiance values
+	//
+	void ToDisplay(Bgra* texels, const float3* radiance, int count, const Settings& settings);
+}
@@ -0,0 +1,282 @@
+#include <RayTracer/Viewer.h>
+#include <RayTracer/Renderer.h>
+#include <RayTracer/RenderTarget.h>
+#include <Image/Tga.h>
+#include <System/Input.h>
+#include <System/Window.h>
+#include <System/Dialog.h>
+#include <System/Thread.h>
+#include <System/Time.h>
+#include <Core/Constants.h>
+#include <Core/Generic.h>
+#include <Core/Log.h>
+
+namespace
+{
+	// Camera settings that can be changed in the viewer without re-rendering
+	//
+	const Iso isos[] = { Iso::ISO50, Iso::ISO100, Iso::ISO200, Iso::ISO400, Iso::ISO800, Iso::ISO1600, Iso::ISO3200, Iso::ISO6400, Iso::ISO12800, Iso::ISO25600 };
+	const Shutter shutters[] = { Shutter::SS1, Shutter::SS2, Shutter::SS4, Shutter::SS8, Shutter::SS15, Shutter::SS30, Shutter::SS60, Shutter::SS100, Shutter::SS125, Shutter::SS250, Shutter::SS500, Shutter::SS1000, Shutter::SS2000, Shutter::SS4000 };
+
+	// Return the setting next to value in the table, stopping at either end
+	//
+	template<typename T, int N>
+	T Step(const T (&values)[N], T value, int direction)
+	{
+		for (int i = 0; i < N; ++i)
+		{
+			if (values[i] == value)
+				return values[Clamp(i + direction, 0, N - 1)];
+		}
+
+		return value;
+	}
+}
+
+Viewer::Viewer(Allocator& allocator, Renderer& renderer, Camera& camera, const Scene& scene, const Integrator& integrator) :
+	allocator(allocator), renderer(renderer), camera(camera), scene(scene), integrator(integrator)
+{
+	camera.ApplySettings(lens, fstop, shutter, iso);
+}
+
+bool Viewer::Run(int w, int h)
+{
+	Window window("RayTracer", w, h);
+
+	if (!window.IsValid())
+		return false;
+
+	WindowTarget target(allocator, window);
+
+	target.SetToneMap(GetToneMap());
+
+	accumulation.display = &target;
+
+	renderer.refinable = true;
+
+	StartRender(target, CenterPriority(window.w, window.h));
+
+	while (window.Update())
+	{
+		Message message;
+
+		while (window.ReadMessage(message))
+		{
+			switch (message.type)
+			{
+				case Message::Type::KeyDown:
+					if (message.data == 'S' && Input::KeyDown(0x11))
+						SaveImage(target);
+					if (message.data == 'O' && Input::KeyDown(0x11))
+						LoadReferenceImage();
+					if (message.data == 'E')
+						target.CalculateError(reference, GetToneMap());
+					if (message.data == 'R')
+						StartRender(target, CenterPriority(window.w, window.h));
+					if (message.data == 'V')
+						StartRender(target, ErrorPriority(renderer.errors, renderer.tile_size));
+					if (message.data == 0x26 || message.data == 0x28)
+						ChangeIso(target, message.data == 0x26 ? +1 : -1);
+					if (message.data == 0x25 || message.data == 0x27)
+						ChangeShutter(target, message.data == 0x25 ? -1 : +1);
+					if (message.data == 'T')
+						ChangeCurve(target);
+					if (message.data == 0x1b)
+						renderer.Cancel();
+					break;
+
+				case Message::Type::MouseDown:
+					drag_start = message.data;
+					break;
+
+				case Message::Type::MouseUp:
+					RenderRegion(target, drag_start, message.data);
+					break;
+
+				default:
+					break;
+			}
+		}
+
+		UpdateRender();
+
+		Thread::Sleep(100);
+	}
+
+	StopRender();
+
+	accumulation.display = nullptr;
+
+	return true;
+}
+
+void Viewer::StartRender(WindowTarget& target, const TilePriority& priority)
+{
+	StopRender();
+
+	// Render the whole frame from scratch. The samples are summed so that regions can be
+	// refined with more of them later, and the means are shown in the window.
+
+	target.Resize(target.window.w, target.window.h);
+
+	accumulation.Reset(allocator, target.window.w, target.window.h);
+
+	renderer.first_sample = 0;
+	renderer.last_sample = 0;
+
+	next_sample = renderer.quality * renderer.quality;
+
+	renderer.Start(accumulation, camera, scene, integrator, priority);
+
+	rendering = true;
+}
+
+void Viewer::RenderRegion(WindowTarget& target, int from, int to)
+{
+	// Mouse positions are packed as signed 16 bit x and y, and may be outside the window if
+	// the drag ended outside it
+
+	const int x0 = Clamp<int>(int16_t(from & 0xffff), 0, target.window.w);
+	const int y0 = Clamp<int>(int16_t(from >> 16), 0, target.window.h);
+	const int x1 = Clamp<int>(int16_t(to & 0xffff), 0, target.window.w);
+	const int y1 = Clamp<int>(int16_t(to >> 16), 0, target.window.h);
+
+	const Tile region(Min(x0, x1), Min(y0, y1), Max(x0, x1) - Min(x0, x1), Max(y0, y1) - Min(y0, y1));
+
+	// Ignore clicks without a drag
+
+	if (region.w < 2 || region.h < 2)
+		return;
+
+	// Regions add more samples to the previous result, which is lost if the window has been
+	// resized, so render the whole frame instead
+
+	if (accumulation.sums.w != target.window.w || accumulation.sums.h != target.window.h)
+	{
+		StartRender(target, CenterPriority(target.window.w, target.window.h));
+		return;
+	}
+
+	// Render the next set of samples for the region ahead of the rest of the frame, or on its
+	// own if the frame is done
+
+	const int first = next_sample;
+	const int last = first + renderer.quality * renderer.quality;
+
+	if (!rendering || !renderer.Refine(&region, 1, first, last))
+	{
+		if (renderer.IsRunning())
+		{
+			LOG_WARNING("Too many regions are waiting to be refined, try again once the render has caught up");
+			return;
+		}
+
+		UpdateRender();
+
+		renderer.first_sample = first;
+		renderer.last_sample = last;
+
+		renderer.Start(accumulation, camera, scene, integrator, CenterPriority(target.window.w, target.window.h), &region, 1);
+
+		rendering = true;
+	}
+
+	next_sample = last;
+
+	LOG_INFO("Refining region %i, %i, %i x %i with samples [%i, %i)", region.x, region.y, region.w, region.h, first, last);
+}
+
+void Viewer::StopRender()
+{
+	if (!rendering)
+		return;
+
+	renderer.Cancel();
+	renderer.Wait();
+
+	rendering = false;
+}
+
+void Viewer::UpdateRender()
+{
+	// Wait on the workers from the message loop so that the window stays responsive while the
+	// render is in progress
+
+	if (rendering && !renderer.IsRunning())
+	{
+		renderer.Wait();
+		rendering = false;
+	}
+}
+
+void Viewer::ChangeIso(WindowTarget& target, int direction)
+{
+	iso = Step(isos, iso, direction);
+
+	ApplyToneMap(target);
+}
+
+void Viewer::ChangeShutter(WindowTarget& target, int direction)
+{
+	shutter = Step(shutters, shutter, direction);
+
+	ApplyToneMap(target);
+}
+
+void Viewer::ChangeCurve(WindowTarget& target)
+{
+	curve = curve == ToneMap::Curve::Aces ? ToneMap::Curve::Clamp : ToneMap::Curve::Aces;
+
+	ApplyToneMap(target);
+}
+
+void Viewer::ApplyToneMap(WindowTarget& target)
+{
+	// ISO and shutter speed only affect the exposure, so the stored radiance can be re-tone
+	// mapped rather than re-rendered. Tiles in flight pick up the new settings when written.
+
+	const uint64_t start = Time::Now();
+
+	camera.ApplySettings(lens, fstop, shutter, iso);
+
+	target.SetToneMap(GetToneMap());
+
+	const float elapsed = Time::Elapsed(start, Time::Now());
+
+	LOG_INFO("ISO %i, shutter 1/%i s, %s curve (%.1f ms)", int(iso), int(shutter), curve == ToneMap::Curve::Aces ? "ACES" : "clamp", elapsed * 1000);
+}
+
+ToneMap::Settings Viewer::GetToneMap() const
+{
+	return { camera.exposure, curve };
+}
+
+void Viewer::SaveImage(const FramebufferTarget& target)
+{
+	// Don't save a partially rendered image
+
+	UpdateRender();
+
+	if (rendering)
+	{
+		LOG_WARNING("Can't save while the render is in progress, try again once it has finished");
+		return;
+	}
+
+	char path[max_path_length] = { 0 };
+
+	if (!Dialog::GetSaveFilename(path, sizeof(path), ".", "Targa (*.tga)\0*.tga\0Portable Float Map (*.pfm)\0*.pfm\0"))
+		return;
+
+	target.Save(path, GetToneMap());
+}
+
+void Viewer::LoadReferenceImage()
+{
+	char path[max_path_length] = { 0 };
+
+	if (!Dialog::GetOpenFilename(path, sizeof(path), ".", "Targa (*.tga)\0*.tga\0"))
+		return;
+
+	Tga::LoadImage(reference, allocator, path);
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <RayTracer/Accumulation.h>
+#include <RayTracer/Camera.h>
+#include <RayTracer/ToneMap.h>
+#include <Image/Image.h>
+
+struct Allocator;
+struct Renderer;
+struct Scene;
+struct Integrator;
+struct TilePriority;
+struct FramebufferTarget;
+struct WindowTarget;
+
+// Window that shows the render as it progresses. The exposure and tone curve can be changed
+// without re-rendering, and dragging out a region adds more samples to it.
+//
+struct Viewer
+{
+	Viewer(Allocator& allocator, Renderer& renderer, Camera& camera, const Scene& scene, const Integrator& integrator);
+
+	Viewer(const Viewer&) = delete;
+	void operator=(const Viewer&) = delete;
+
+	// Open a window and render into it until it's closed
+	//
+	bool Run(int w, int h);
+
+	// Start rendering the whole frame from scratch
+	//
+	void StartRender(WindowTarget& target, const TilePriority& priority);
+
+	// Add the next set of samples to the region between two packed mouse positions
+	//
+	void RenderRegion(WindowTarget& target, int from, int to);
+
+	// Cancel the render and wait for it to stop
+	//
+	void StopRender();
+
+	// Wait on the render once it has finished
+	//
+	void UpdateRender();
+
+	// Step the camera settings, or switch the tone curve, and re-tone map the image
+	//
+	void ChangeIso(WindowTarget& target, int direction);
+	void ChangeShutter(WindowTarget& target, int direction);
+	void ChangeCurve(WindowTarget& target);
+	void ApplyToneMap(WindowTarget& target);
+
+	// Tone map settings for the current camera settings and curve
+	//
+	ToneMap::Settings GetToneMap() const;
+
+	// Ask for a path and save the image or load a reference image
+	//
+	void SaveImage(const FramebufferTarget& target);
+	void LoadReferenceImage();
+
+	// Rendering state owned by the caller
+	//
+	Allocator& allocator;
+	Renderer& renderer;
+	Camera& camera;
+	const Scene& scene;
+	const Integrator& integrator;
+
+	// Sample sums for the render, shown in the window as they're written
+	//
+	AccumulationTarget accumulation;
+
+	// First sample of the next set to add when refining a region
+	//
+	int next_sample = 0;
+
+	// True while a background render hasn't been waited on
+	//
+	bool rendering = false;
+
+	// Packed mouse position where the current drag started
+	//
+	int drag_start = 0;
+
+	// Camera settings
+	//
+	Lens lens = Lens::FL35mm;
+	FStop fstop = FStop::F16;
+	Shutter shutter = Shutter::SS100;
+	Iso iso = Iso::ISO100;
+
+	// Tone curve for the display
+	//
+	ToneMap::Curve curve = ToneMap::Curve::Aces;
+
+	// Ground-truth reference image
+	//
+	Image<Bgra> reference;
+};
@@ -1,7 +1,16 @@
 #pragma once
 
+#include <Core/Types.h>
+
 struct File
 {
+	enum class Access
+	{
+		Normal,
+		Sequential,
+		Random
+	};
+
 	File() = default;
 
 	File(const File&) = delete;
@@ -16,9 +25,19 @@ struct File
 	//
 	bool OpenForWrite(const char* filename, size_t filesize);
 
-	// Open a file with read-only access
+	// Open a file with read-only access. The access pattern is a hint for the OS read-ahead
+	//
+	bool OpenForRead(const char* filename, Access access = Access::Sequential);
+
+	// Create a file that is written at explicit offsets with WriteAt rather than through a
+	// mapping, so that it can be far larger than the address space or memory
+	//
+	bool OpenForStreaming(const char* filename);
+
+	// Write data at an offset from the start of a file opened for streaming. Offsets can be
+	// written in any order, and gaps read back as zero.
 	//
-	bool OpenForRead(const char* filename);
+	bool WriteAt(uint64_t offset, const void* data, size_t size) const;
 
 	// Shrink the file to the specified size and close
 	//
@@ -28,6 +47,15 @@ struct File
 	//
 	void Close();
 
+	// Return true if a file exists at the path
+	//
+	static bool Exists(const char* filename);
+
+	// Move a file over another one, replacing it in a single step so that readers see either
+	// the old or the new file
+	//
+	static bool Replace(const char* from, const char* to);
+
 	// Handle to the os file
 	//
 	void* file = nullptr;
@@ -1,8 +1,22 @@
 #pragma once
 
+#include <Core/Types.h>
+
 namespace Host
 {
-	// Get the number of physical cores on the host machine
+	// Get the number of processors available to this process on the host machine
 	//
 	int GetCpuCoreCount();
-}
\ No newline at end of file
+
+	// Get the number of NUMA nodes on the host machine
+	//
+	int GetNumaNodeCount();
+
+	// Get the NUMA node that the processor belongs to
+	//
+	int GetNumaNode(int cpu);
+
+	// Get the most physical memory the process has used so far in bytes
+	//
+	size_t GetPeakMemoryUsage();
+}
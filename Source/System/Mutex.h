@@ -0,0 +1,46 @@
+#pragma once
+
+struct Mutex
+{
+	Mutex();
+
+	Mutex(const Mutex&) = delete;
+	void operator=(const Mutex&) = delete;
+
+	Mutex(Mutex&& other) = delete;
+	void operator=(Mutex&& other) = delete;
+
+	~Mutex();
+
+	// Wait until the mutex is available and take ownership
+	//
+	void Lock();
+
+	// Release ownership of the mutex
+	//
+	void Unlock();
+
+	// The native lock
+	//
+	void* handle = nullptr;
+};
+
+struct ScopedLock
+{
+	ScopedLock(Mutex& mutex) : mutex(mutex)
+	{
+		mutex.Lock();
+	}
+
+	ScopedLock(const ScopedLock&) = delete;
+	void operator=(const ScopedLock&) = delete;
+
+	~ScopedLock()
+	{
+		mutex.Unlock();
+	}
+
+	// The locked mutex
+	//
+	Mutex& mutex;
+};
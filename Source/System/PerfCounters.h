@@ -0,0 +1,59 @@
+#pragma once
+
+#include <Core/Types.h>
+
+// Hardware performance counters for the calling thread. Only available on Linux through
+// perf_event_open, and not at all if the kernel or a virtual machine doesn't expose them, so
+// callers have to cope with some or all counters being missing.
+//
+struct PerfCounters
+{
+	enum class Counter
+	{
+		Cycles,
+		Instructions,
+		CacheMisses,
+		BranchMisses,
+		BackendStalls,
+		Count
+	};
+
+	static constexpr int counter_count = int(Counter::Count);
+
+	PerfCounters() = default;
+
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	~PerfCounters();
+
+	// Start counting on the calling thread. Returns false if no counters are available
+	//
+	bool Open();
+
+	// Stop counting
+	//
+	void Close();
+
+	// Read the counts so far into values, with counters that aren't available reading as 0
+	//
+	void Read(uint64_t* values);
+
+	// Return true if the counter could be opened and, as of the last read, has been scheduled
+	// onto the hardware. Counters that open but never count, e.g. under a hypervisor that
+	// doesn't pass them through, would otherwise read as zero.
+	//
+	bool IsAvailable(Counter counter) const;
+
+	// Return a short name for the counter
+	//
+	static const char* GetName(Counter counter);
+
+	// The native counters, null if unavailable
+	//
+	void* handles[counter_count] = {};
+
+	// Set once a read finds that the counters have been running
+	//
+	bool scheduled = false;
+};
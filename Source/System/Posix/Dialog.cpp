@@ -0,0 +1,38 @@
+#include <System/Dialog.h>
+#include <Core/Types.h>
+#include <Core/Log.h>
+
+// There are no native dialogs on POSIX hosts. Paths should be passed on the command line instead.
+
+bool Dialog::GetOpenFilename(char* buffer, int capacity, const char* directory, const char* filter)
+{
+	unused(capacity);
+	unused(directory);
+	unused(filter);
+
+	buffer[0] = 0;
+
+	LOG_ERROR("File dialogs are not supported on this platform");
+
+	return false;
+}
+
+bool Dialog::GetSaveFilename(char* buffer, int capacity, const char* directory, const char* filter)
+{
+	unused(capacity);
+	unused(directory);
+	unused(filter);
+
+	buffer[0] = 0;
+
+	LOG_ERROR("File dialogs are not supported on this platform");
+
+	return false;
+}
+
+bool Dialog::ShowYesNo(const char* title, const char* text)
+{
+	LOG_WARNING("%s: %s (assuming no)", title, text);
+
+	return false;
+}
@@ -0,0 +1,245 @@
+#include <System/File.h>
+#include <Core/Log.h>
+#include <Core/Types.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdio.h>
+
+namespace
+{
+	// The file handle stores the descriptor offset by one so that a null handle still means
+	// there is no open file, matching the Win32 implementation.
+
+	void* ToHandle(int descriptor)
+	{
+		return reinterpret_cast<void*>(intptr_t(descriptor) + 1);
+	}
+
+	int ToDescriptor(void* handle)
+	{
+		return int(reinterpret_cast<intptr_t>(handle) - 1);
+	}
+}
+
+File::File(File&& other) noexcept : 
+	file(other.file),
+	mapping(other.mapping),
+	contents(other.contents),
+	size(other.size)
+{
+	other.file = nullptr;
+	other.mapping = nullptr;
+	other.contents = nullptr;
+}
+
+File& File::operator=(File&& other) noexcept
+{
+	Close();
+
+	file = other.file;
+	mapping = other.mapping;
+	contents = other.contents;
+	size = other.size;
+
+	other.file = nullptr;
+	other.mapping = nullptr;
+	other.contents = nullptr;
+
+	return *this;
+}
+
+File::~File()
+{
+	Close();
+}
+
+bool File::OpenForWrite(const char* filename, size_t filesize)
+{
+	const int descriptor = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+	if (descriptor < 0)
+	{
+		LOG_ERROR("[%i] Couldn't create file handle for %s", errno, filename);
+		return false;
+	}
+
+	file = ToHandle(descriptor);
+
+	if (ftruncate(descriptor, off_t(filesize)) != 0)
+	{
+		LOG_ERROR("[%i] Couldn't resize %s", errno, filename);
+		return false;
+	}
+
+	void* view = mmap(nullptr, filesize, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+
+	if (view == MAP_FAILED)
+	{
+		LOG_ERROR("[%i] Couldn't map a view onto %s", errno, filename);
+		return false;
+	}
+
+	// Writers fill the file from front to back
+
+	madvise(view, filesize, MADV_SEQUENTIAL);
+
+	contents = view;
+	size = filesize;
+
+	return true;
+}
+
+bool File::OpenForStreaming(const char* filename)
+{
+	const int descriptor = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+	if (descriptor < 0)
+	{
+		LOG_ERROR("[%i] Couldn't create file handle for %s", errno, filename);
+		return false;
+	}
+
+	file = ToHandle(descriptor);
+
+	return true;
+}
+
+bool File::WriteAt(uint64_t offset, const void* data, size_t size) const
+{
+	const uint8_t* head = static_cast<const uint8_t*>(data);
+
+	while (size > 0)
+	{
+		const ssize_t written = pwrite(ToDescriptor(file), head, size, off_t(offset));
+
+		if (written < 0 && errno == EINTR)
+			continue;
+
+		if (written <= 0)
+		{
+			LOG_ERROR("[%i] Couldn't write %zu bytes at offset %llu", errno, size, (unsigned long long)offset);
+			return false;
+		}
+
+		head += written;
+		offset += uint64_t(written);
+		size -= size_t(written);
+	}
+
+	return true;
+}
+
+bool File::OpenForRead(const char* filename, Access access)
+{
+	const int descriptor = open(filename, O_RDONLY);
+
+	if (descriptor < 0)
+	{
+		LOG_ERROR("Failed to open file '%s' with error %i", filename, errno);
+		return false;
+	}
+
+	file = ToHandle(descriptor);
+
+	struct stat info;
+
+	if (fstat(descriptor, &info) != 0)
+	{
+		LOG_ERROR("Failed to read the size of file '%s'", filename);
+		return false;
+	}
+
+	size = size_t(info.st_size);
+
+	// Mapping an empty file fails, so leave the contents empty
+
+	if (size == 0)
+		return true;
+
+	// Use a private mapping to match the copy-on-write view used on Win32
+
+	void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, descriptor, 0);
+
+	if (view == MAP_FAILED)
+	{
+		LOG_ERROR("Failed to map file '%s' with error %i", filename, errno);
+		return false;
+	}
+
+	// Hint the access pattern to the kernel so it can tune read-ahead. Sequential readers 
+	// will touch the whole file, so start paging it in straight away.
+
+	switch (access)
+	{
+		case Access::Sequential:
+			madvise(view, size, MADV_SEQUENTIAL);
+			madvise(view, size, MADV_WILLNEED);
+			break;
+
+		case Access::Random:
+			madvise(view, size, MADV_RANDOM);
+			break;
+
+		default:
+			break;
+	}
+
+	contents = view;
+
+	return true;
+}
+
+void File::Close(size_t filesize)
+{
+	if (contents)
+	{
+		munmap(contents, size);
+		contents = nullptr;
+	}
+
+	if (file)
+	{
+		if (ftruncate(ToDescriptor(file), off_t(filesize)) != 0)
+			LOG_ERROR("[%i] Couldn't resize file", errno);
+
+		close(ToDescriptor(file));
+
+		file = nullptr;
+	}
+}
+
+void File::Close()
+{
+	if (contents)
+	{
+		munmap(contents, size);
+		contents = nullptr;
+	}
+
+	if (file)
+	{
+		close(ToDescriptor(file));
+		file = nullptr;
+	}
+}
+
+bool File::Exists(const char* filename)
+{
+	struct stat info;
+
+	return stat(filename, &info) == 0 && S_ISREG(info.st_mode);
+}
+
+bool File::Replace(const char* from, const char* to)
+{
+	if (rename(from, to) != 0)
+	{
+		LOG_ERROR("[%i] Couldn't move %s to %s", errno, from, to);
+		return false;
+	}
+
+	return true;
+}
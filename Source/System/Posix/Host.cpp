@@ -0,0 +1,102 @@
+#include <System/Host.h>
+#include <Core/Generic.h>
+#include <sys/resource.h>
+#include <dirent.h>
+#include <sched.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+	// Return the number of the first entry in the directory that looks like 'prefix<number>' or
+	// -1 if there isn't one. If count is supplied, then it will be set to the number of matches.
+
+	int FindNumberedEntry(const char* path, const char* prefix, int* count = nullptr)
+	{
+		DIR* directory = opendir(path);
+
+		if (!directory)
+			return -1;
+
+		const size_t length = strlen(prefix);
+
+		int first = -1;
+		int matches = 0;
+
+		while (const dirent* entry = readdir(directory))
+		{
+			if (strncmp(entry->d_name, prefix, length) != 0)
+				continue;
+
+			char* end = nullptr;
+
+			const long number = strtol(entry->d_name + length, &end, 10);
+
+			if (end == entry->d_name + length || *end != '\0')
+				continue;
+
+			if (first < 0)
+				first = int(number);
+
+			matches++;
+		}
+
+		closedir(directory);
+
+		if (count)
+			*count = matches;
+
+		return first;
+	}
+}
+
+int Host::GetCpuCoreCount()
+{
+	// Respect the affinity mask of the process (e.g. taskset or a container cpuset) so that
+	// we don't create more workers than we can actually run.
+
+#ifdef __linux__
+	cpu_set_t set;
+
+	if (sched_getaffinity(0, sizeof(set), &set) == 0)
+		return Max(CPU_COUNT(&set), 1);
+#endif
+
+	return Max(int(sysconf(_SC_NPROCESSORS_ONLN)), 1);
+}
+
+int Host::GetNumaNodeCount()
+{
+	int count = 0;
+
+	FindNumberedEntry("/sys/devices/system/node", "node", &count);
+
+	return Max(count, 1);
+}
+
+int Host::GetNumaNode(int cpu)
+{
+	char path[64];
+
+	snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%i", cpu);
+
+	return Max(FindNumberedEntry(path, "node"), 0);
+}
+
+size_t Host::GetPeakMemoryUsage()
+{
+	rusage usage;
+
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+
+	// Linux reports the peak resident set in KiB, and macOS in bytes
+
+#ifdef __APPLE__
+	return size_t(usage.ru_maxrss);
+#else
+	return size_t(usage.ru_maxrss) * 1024;
+#endif
+}
@@ -0,0 +1,11 @@
+#include <System/Input.h>
+#include <Core/Types.h>
+
+bool Input::KeyDown(int code)
+{
+	// There is no native window on POSIX hosts, so no keys are ever down
+
+	unused(code);
+
+	return false;
+}
@@ -0,0 +1,24 @@
+#include <System/Mutex.h>
+#include <pthread.h>
+
+Mutex::Mutex() : handle(new pthread_mutex_t)
+{
+	pthread_mutex_init(static_cast<pthread_mutex_t*>(handle), nullptr);
+}
+
+Mutex::~Mutex()
+{
+	pthread_mutex_destroy(static_cast<pthread_mutex_t*>(handle));
+
+	delete static_cast<pthread_mutex_t*>(handle);
+}
+
+void Mutex::Lock()
+{
+	pthread_mutex_lock(static_cast<pthread_mutex_t*>(handle));
+}
+
+void Mutex::Unlock()
+{
+	pthread_mutex_unlock(static_cast<pthread_mutex_t*>(handle));
+}
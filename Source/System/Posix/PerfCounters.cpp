@@ -0,0 +1,181 @@
+#include <System/PerfCounters.h>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+namespace
+{
+	// The handle stores the descriptor offset by one so that a null handle means the counter
+	// isn't available
+
+	void* ToHandle(int descriptor)
+	{
+		return reinterpret_cast<void*>(intptr_t(descriptor) + 1);
+	}
+
+	int ToDescriptor(void* handle)
+	{
+		return int(reinterpret_cast<intptr_t>(handle) - 1);
+	}
+
+#ifdef __linux__
+	struct CounterConfig
+	{
+		uint32_t type;
+		uint64_t config;
+	};
+
+	const CounterConfig configs[PerfCounters::counter_count] =
+	{
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_BACKEND },
+	};
+#endif
+}
+
+PerfCounters::~PerfCounters()
+{
+	Close();
+}
+
+bool PerfCounters::Open()
+{
+	Close();
+
+#ifdef __linux__
+	// The counters are opened as one group led by the first that opens, so that they're
+	// scheduled onto the hardware together and all read with a single call. Counters that
+	// the processor doesn't support are left out.
+
+	int leader = -1;
+	bool any = false;
+
+	for (int i = 0; i < counter_count; ++i)
+	{
+		perf_event_attr attributes;
+
+		memset(&attributes, 0, sizeof(attributes));
+
+		attributes.size = sizeof(attributes);
+		attributes.type = configs[i].type;
+		attributes.config = configs[i].config;
+		attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+		attributes.exclude_kernel = 1;
+		attributes.exclude_hv = 1;
+
+		const int descriptor = int(syscall(SYS_perf_event_open, &attributes, 0, -1, leader, 0));
+
+		if (descriptor < 0)
+			continue;
+
+		if (leader < 0)
+			leader = descriptor;
+
+		handles[i] = ToHandle(descriptor);
+		any = true;
+	}
+
+	return any;
+#else
+	return false;
+#endif
+}
+
+void PerfCounters::Close()
+{
+	// Close the group members before the leader, which is the first open counter
+
+	for (int i = counter_count - 1; i >= 0; --i)
+	{
+		if (!handles[i])
+			continue;
+
+#ifdef __linux__
+		close(ToDescriptor(handles[i]));
+#endif
+
+		handles[i] = nullptr;
+	}
+
+	scheduled = false;
+}
+
+void PerfCounters::Read(uint64_t* values)
+{
+	for (int i = 0; i < counter_count; ++i)
+		values[i] = 0;
+
+#ifdef __linux__
+	int leader = -1;
+
+	for (int i = 0; i < counter_count && leader < 0; ++i)
+	{
+		if (handles[i])
+			leader = ToDescriptor(handles[i]);
+	}
+
+	if (leader < 0)
+		return;
+
+	// The group is read as the member count, the times enabled and running, then a value
+	// for each member in the order they were opened
+
+	uint64_t buffer[3 + counter_count];
+
+	const ssize_t size = read(leader, buffer, sizeof(buffer));
+
+	if (size < ssize_t(3 * sizeof(uint64_t)))
+		return;
+
+	const uint64_t count = buffer[0];
+	const uint64_t enabled = buffer[1];
+	const uint64_t running = buffer[2];
+
+	// A group that has never been running hasn't counted anything, so its zeros mean the
+	// counters are unavailable rather than idle
+
+	if (running == 0)
+		return;
+
+	scheduled = true;
+
+	// Scale up the counts if the group had to share the hardware with other events
+
+	const double scale = running < enabled ? double(enabled) / running : 1.0;
+
+	uint64_t member = 0;
+
+	for (int i = 0; i < counter_count && member < count; ++i)
+	{
+		if (handles[i])
+			values[i] = uint64_t(buffer[3 + member++] * scale);
+	}
+#endif
+}
+
+bool PerfCounters::IsAvailable(Counter counter) const
+{
+	return handles[int(counter)] != nullptr && scheduled;
+}
+
+const char* PerfCounters::GetName(Counter counter)
+{
+	static const char* const names[counter_count] =
+	{
+		"cycles",
+		"instructions",
+		"cache misses",
+		"branch misses",
+		"backend stalls",
+	};
+
+	return names[int(counter)];
+}
@@ -0,0 +1,50 @@
+#include <System/Process.h>
+#include <Core/Constants.h>
+#include <Core/Log.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <errno.h>
+
+extern char** environ;
+
+bool Process::SpawnSelf(const char* const* args, int count)
+{
+	char path[max_path_length + 1];
+
+	const ssize_t length = readlink("/proc/self/exe", path, max_path_length);
+
+	if (length <= 0)
+	{
+		LOG_ERROR("[%i] Failed to find the current executable", errno);
+		return false;
+	}
+
+	path[length] = 0;
+
+	char* argv[64];
+
+	if (count + 2 > countof(argv))
+	{
+		LOG_ERROR("Too many arguments to start %s", path);
+		return false;
+	}
+
+	argv[0] = path;
+
+	for (int i = 0; i < count; ++i)
+		argv[i + 1] = const_cast<char*>(args[i]);
+
+	argv[count + 1] = nullptr;
+
+	pid_t pid;
+
+	const int result = posix_spawn(&pid, path, nullptr, nullptr, argv, environ);
+
+	if (result != 0)
+	{
+		LOG_ERROR("[%i] Failed to start %s", result, path);
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,44 @@
+#include <System/Semaphore.h>
+#include <Core/Types.h>
+#include <semaphore.h>
+#include <errno.h>
+
+// Unnamed semaphores are used since named POSIX semaphores outlive the process. The name is
+// only used by the Win32 implementation.
+
+Semaphore::Semaphore(const char* name, int count) :
+	handle(new sem_t), count(count)
+{
+	unused(name);
+
+	sem_init(static_cast<sem_t*>(handle), 0, 0);
+}
+
+Semaphore::~Semaphore()
+{
+	if (!handle)
+		return;
+
+	sem_destroy(static_cast<sem_t*>(handle));
+
+	delete static_cast<sem_t*>(handle);
+}
+
+void Semaphore::Raise() const
+{
+	// Win32 semaphores have a max count, so top up to the max rather than adding count
+
+	int value = 0;
+
+	sem_getvalue(static_cast<sem_t*>(handle), &value);
+
+	for (int i = value; i < count; ++i)
+		sem_post(static_cast<sem_t*>(handle));
+}
+
+void Semaphore::Wait() const
+{
+	while (sem_wait(static_cast<sem_t*>(handle)) != 0 && errno == EINTR)
+	{
+	}
+}
@@ -0,0 +1,239 @@
+#include <System/Socket.h>
+#include <Core/Log.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <errno.h>
+#include <cstdio>
+
+namespace
+{
+	// The handle stores the descriptor offset by one so that a null handle means there is no
+	// socket, matching the Win32 implementation.
+
+	void* ToHandle(int descriptor)
+	{
+		return reinterpret_cast<void*>(intptr_t(descriptor) + 1);
+	}
+
+	int ToDescriptor(void* handle)
+	{
+		return int(reinterpret_cast<intptr_t>(handle) - 1);
+	}
+
+	// Don't raise SIGPIPE when writing to a connection that the peer has closed
+
+#ifdef MSG_NOSIGNAL
+	const int send_flags = MSG_NOSIGNAL;
+#else
+	const int send_flags = 0;
+#endif
+
+	void DisableNagle(int descriptor)
+	{
+		const int nodelay = 1;
+
+		setsockopt(descriptor, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+	}
+}
+
+Socket::Socket(Socket&& other) noexcept : handle(other.handle)
+{
+	other.handle = nullptr;
+}
+
+Socket& Socket::operator=(Socket&& other) noexcept
+{
+	Close();
+
+	handle = other.handle;
+
+	other.handle = nullptr;
+
+	return *this;
+}
+
+Socket::~Socket()
+{
+	Close();
+}
+
+bool Socket::Listen(int port)
+{
+	Close();
+
+	const int descriptor = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+	if (descriptor < 0)
+	{
+		LOG_ERROR("[%i] Failed to create socket", errno);
+		return false;
+	}
+
+	handle = ToHandle(descriptor);
+
+	const int reuse = 1;
+
+	setsockopt(descriptor, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+	sockaddr_in address = {};
+
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+	address.sin_port = htons(uint16_t(port));
+
+	if (bind(descriptor, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(descriptor, SOMAXCONN) != 0)
+	{
+		LOG_ERROR("[%i] Failed to listen on port %i", errno, port);
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+bool Socket::Accept(Socket& connection) const
+{
+	int descriptor;
+
+	do
+	{
+		descriptor = accept(ToDescriptor(handle), nullptr, nullptr);
+	}
+	while (descriptor < 0 && errno == EINTR);
+
+	if (descriptor < 0)
+	{
+		LOG_ERROR("[%i] Failed to accept connection", errno);
+		return false;
+	}
+
+	DisableNagle(descriptor);
+
+	connection.Close();
+	connection.handle = ToHandle(descriptor);
+
+	return true;
+}
+
+bool Socket::Connect(const char* host, int port)
+{
+	Close();
+
+	char service[16];
+
+	snprintf(service, sizeof(service), "%i", port);
+
+	addrinfo hints = {};
+
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_protocol = IPPROTO_TCP;
+
+	addrinfo* addresses = nullptr;
+
+	const int resolved = getaddrinfo(host, service, &hints, &addresses);
+
+	if (resolved != 0)
+	{
+		LOG_ERROR("Failed to resolve %s (%s)", host, gai_strerror(resolved));
+		return false;
+	}
+
+	for (const addrinfo* a = addresses; a; a = a->ai_next)
+	{
+		const int descriptor = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+
+		if (descriptor < 0)
+			continue;
+
+		if (connect(descriptor, a->ai_addr, a->ai_addrlen) == 0)
+		{
+			handle = ToHandle(descriptor);
+			break;
+		}
+
+		close(descriptor);
+	}
+
+	freeaddrinfo(addresses);
+
+	if (!handle)
+	{
+		LOG_ERROR("[%i] Failed to connect to %s:%i", errno, host, port);
+		return false;
+	}
+
+	DisableNagle(ToDescriptor(handle));
+
+	return true;
+}
+
+bool Socket::Poll(int ms) const
+{
+	pollfd fd = {};
+
+	fd.fd = ToDescriptor(handle);
+	fd.events = POLLIN;
+
+	return poll(&fd, 1, ms) > 0;
+}
+
+bool Socket::Send(const void* data, size_t size) const
+{
+	const char* head = static_cast<const char*>(data);
+
+	while (size > 0)
+	{
+		const ssize_t sent = send(ToDescriptor(handle), head, size, send_flags);
+
+		if (sent < 0 && errno == EINTR)
+			continue;
+
+		if (sent <= 0)
+			return false;
+
+		head += sent;
+		size -= size_t(sent);
+	}
+
+	return true;
+}
+
+bool Socket::Receive(void* data, size_t size) const
+{
+	char* head = static_cast<char*>(data);
+
+	while (size > 0)
+	{
+		const ssize_t received = recv(ToDescriptor(handle), head, size, 0);
+
+		if (received < 0 && errno == EINTR)
+			continue;
+
+		if (received <= 0)
+			return false;
+
+		head += received;
+		size -= size_t(received);
+	}
+
+	return true;
+}
+
+void Socket::Close()
+{
+	if (handle)
+	{
+		close(ToDescriptor(handle));
+		handle = nullptr;
+	}
+}
+
+bool Socket::IsOpen() const
+{
+	return handle != nullptr;
+}
@@ -0,0 +1,211 @@
+#include <System/SystemAllocator.h>
+#include <System/Host.h>
+#include <Core/Constants.h>
+#include <Core/Assert.h>
+#include <Core/Generic.h>
+#include <Core/Pointer.h>
+#include <Core/Log.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#endif
+
+namespace
+{
+	void* Reserve(size_t size)
+	{
+		void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+		CRITICAL(memory != MAP_FAILED, "Failed to map %llu bytes of system memory", (unsigned long long)size);
+
+		return memory;
+	}
+
+	size_t GetPageSize()
+	{
+		static const size_t page_size = size_t(sysconf(_SC_PAGESIZE));
+
+		return page_size;
+	}
+
+	// Map memory aligned beyond the page size, by mapping more than needed and trimming the ends
+	//
+	void* ReserveAligned(size_t size, size_t alignment)
+	{
+		uint8_t* mapping = static_cast<uint8_t*>(Reserve(size + alignment));
+		uint8_t* aligned = Pointer::Align(mapping, alignment);
+
+		if (aligned > mapping)
+			munmap(mapping, aligned - mapping);
+
+		munmap(aligned + size, (mapping + alignment) - aligned);
+
+		return aligned;
+	}
+
+#ifdef __linux__
+	// Map explicit huge pages, which only exist if the administrator has reserved some
+	//
+	void* ReserveHuge(size_t size, size_t page_size, int page_shift)
+	{
+		if (size % page_size != 0)
+			return nullptr;
+
+		void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (page_shift << MAP_HUGE_SHIFT), -1, 0);
+
+		return memory != MAP_FAILED ? memory : nullptr;
+	}
+
+	// Set the memory to be spread across all nodes as it's touched. This calls mbind directly
+	// rather than linking libnuma for one call.
+	//
+	bool Interleave(void* memory, size_t size)
+	{
+		const int nodes = Host::GetNumaNodeCount();
+
+		unsigned long mask[4] = {};
+
+		for (int i = 0; i < nodes && i < int(8 * sizeof(mask)); ++i)
+			mask[i / 64] |= 1ul << (i % 64);
+
+		return syscall(SYS_mbind, memory, size, MPOL_INTERLEAVE, mask, 8 * sizeof(mask), 0) == 0;
+	}
+#endif
+
+	SystemAllocator::Mapping Map(size_t size, const SystemAllocator::Settings& settings)
+	{
+		SystemAllocator::Mapping mapping;
+
+#ifdef __linux__
+		const char* pages = "small";
+
+		if (settings.huge_pages)
+		{
+			if ((mapping.memory = ReserveHuge(size, 1_GiB, 30)) != nullptr)
+			{
+				mapping.page_size = 1_GiB;
+				pages = "1 GiB";
+			}
+			else if ((mapping.memory = ReserveHuge(size, 2_MiB, 21)) != nullptr)
+			{
+				mapping.page_size = 2_MiB;
+				pages = "2 MiB";
+			}
+			else
+			{
+				// Without reserved huge pages, align the mapping so that the kernel can back it
+				// with transparent huge pages as they're touched
+
+				mapping.memory = ReserveAligned(size, 2_MiB);
+
+				if (madvise(mapping.memory, size, MADV_HUGEPAGE) == 0)
+				{
+					mapping.page_size = 2_MiB;
+					pages = "transparent 2 MiB";
+				}
+			}
+		}
+
+		if (!mapping.memory)
+			mapping.memory = Reserve(size);
+
+		if (!mapping.page_size)
+			mapping.page_size = GetPageSize();
+
+		// Interleaving only affects pages touched after it's set, and the heap marks all of its
+		// memory when it's created, so this has to happen first
+
+		const bool interleaved = settings.interleave && Host::GetNumaNodeCount() > 1 && Interleave(mapping.memory, size);
+
+		if (settings.interleave && !interleaved)
+			LOG_WARNING("System memory can't be interleaved, there is only one NUMA node or mbind failed");
+
+		LOG_INFO("Create system heap (%iMiB) with %s pages%s", int(size / 1_MiB), pages, interleaved ? ", interleaved across NUMA nodes" : "");
+#else
+		unused(settings);
+
+		mapping.memory = Reserve(size);
+		mapping.page_size = GetPageSize();
+#endif
+
+		return mapping;
+	}
+}
+
+SystemAllocator::SystemAllocator(size_t size) : SystemAllocator(size, Settings())
+{
+}
+
+SystemAllocator::SystemAllocator(size_t size, const Settings& settings) : SystemAllocator(Map(size, settings), size)
+{
+}
+
+SystemAllocator::SystemAllocator(const Mapping& mapping, size_t size) : HeapAllocator(mapping.memory, size), page_size(mapping.page_size)
+{
+}
+
+SystemAllocator::~SystemAllocator()
+{
+	ASSERT(IsEmpty(), "Heap has outstanding allocations");
+
+	munmap(memory, capacity);
+
+	// The system memory may be overwritten with a memory pattern, so clear out the memory
+	// pointer so that the heap destructor doesn't try to read bad data.
+
+	memory = nullptr;
+	head = nullptr;
+}
+
+PageAllocator::~PageAllocator()
+{
+	ASSERT(allocated == 0, "Pages have outstanding allocations");
+}
+
+void* PageAllocator::Allocate(size_t size, size_t alignment)
+{
+	const size_t page_size = GetPageSize();
+	const size_t length = (size + page_size - 1) & ~(page_size - 1);
+
+	alignment = Max(alignment, page_size);
+
+	// mmap only aligns to pages, so map enough to align the allocation and trim the ends. The
+	// page in front of the allocation is kept to record the length for munmap.
+
+	const size_t reserved = length + alignment;
+	uint8_t* mapping = static_cast<uint8_t*>(Reserve(reserved));
+	uint8_t* allocation = Pointer::Align(mapping + page_size, alignment);
+	uint8_t* header = allocation - page_size;
+
+	if (header > mapping)
+		munmap(mapping, header - mapping);
+	if (allocation + length < mapping + reserved)
+		munmap(allocation + length, (mapping + reserved) - (allocation + length));
+
+	*reinterpret_cast<size_t*>(header) = length;
+
+	AddAllocated(length);
+	Memory::OnAllocate(tag, length);
+
+	return allocation;
+}
+
+void PageAllocator::Deallocate(void* allocation)
+{
+	if (!allocation)
+		return;
+
+	const size_t page_size = GetPageSize();
+	uint8_t* header = static_cast<uint8_t*>(allocation) - page_size;
+	const size_t length = *reinterpret_cast<size_t*>(header);
+
+	ASSERT(allocated >= length, "Deallocating pages that were not allocated");
+
+	allocated -= length;
+	Memory::OnDeallocate(tag, length);
+
+	munmap(header, page_size + length);
+}
@@ -0,0 +1,158 @@
+#include <System/Thread.h>
+#include <Core/Assert.h>
+#include <Core/Types.h>
+#include <pthread.h>
+#include <errno.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace
+{
+	struct NativeThread
+	{
+		// Native thread
+		//
+		pthread_t thread;
+
+		// True once the thread has been joined, at which point it can't be detached
+		//
+		bool joined = false;
+	};
+
+	struct Launch
+	{
+		// Function to run on the new thread
+		//
+		Thread::EntryPoint entry_point = nullptr;
+
+		// Parameter to pass to the function
+		//
+		void* parameter = nullptr;
+	};
+
+	void* ThreadMain(void* parameter)
+	{
+		// Take a copy of the launch details so they can be freed before running the thread
+
+		const Launch launch = *static_cast<Launch*>(parameter);
+
+		delete static_cast<Launch*>(parameter);
+
+		launch.entry_point(launch.parameter);
+
+		return nullptr;
+	}
+
+	NativeThread* ToNative(void* handle)
+	{
+		return static_cast<NativeThread*>(handle);
+	}
+}
+
+Thread::Thread(EntryPoint entry_point, void* parameter)
+{
+	NativeThread* native = new NativeThread;
+
+	if (pthread_create(&native->thread, nullptr, ThreadMain, new Launch{ entry_point, parameter }) != 0)
+	{
+		CRITICAL(false, "Failed to create thread");
+		delete native;
+		return;
+	}
+
+	handle = native;
+}
+
+Thread::Thread(Thread&& other) noexcept : handle(other.handle)
+{
+	other.handle = nullptr;
+}
+
+Thread& Thread::operator=(Thread&& other) noexcept
+{
+	this->~Thread();
+
+	handle = other.handle;
+
+	other.handle = nullptr;
+
+	return *this;
+}
+
+Thread::~Thread()
+{
+	NativeThread* native = ToNative(handle);
+
+	if (!native)
+		return;
+
+	// Match the Win32 behavior where closing the handle lets the thread run to completion
+
+	if (!native->joined)
+		pthread_detach(native->thread);
+
+	delete native;
+
+	handle = nullptr;
+}
+
+void Thread::SetIdealProcessor(int i) const
+{
+#ifdef __linux__
+	// There's no ideal processor hint on Linux, so pin the thread to the processor instead.
+	// This keeps a worker's caches warm since the scheduler won't migrate it. Processors are
+	// numbered within the affinity mask of the calling thread (e.g. from taskset or a container
+	// cpuset), so workers are only pinned to processors the process is allowed to run on.
+
+	cpu_set_t allowed;
+
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) == 0)
+		return;
+
+	int cpu = -1;
+
+	for (int remaining = i % CPU_COUNT(&allowed); remaining >= 0;)
+	{
+		if (CPU_ISSET(++cpu, &allowed))
+			--remaining;
+	}
+
+	cpu_set_t set;
+
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+
+	pthread_setaffinity_np(ToNative(handle)->thread, sizeof(set), &set);
+#else
+	unused(i);
+#endif
+}
+
+void Thread::Join() const
+{
+	NativeThread* native = ToNative(handle);
+
+	ASSERT(!native->joined, "Thread has already been joined");
+
+	pthread_join(native->thread, nullptr);
+
+	native->joined = true;
+}
+
+void Thread::Sleep(int ms)
+{
+	timespec duration = { ms / 1000, (ms % 1000) * 1000000L };
+
+	// Keep sleeping for the remaining time if a signal wakes us up early
+
+	while (nanosleep(&duration, &duration) != 0 && errno == EINTR)
+	{
+	}
+}
+
+void Join(const Thread* threads, int count)
+{
+	for (int i = 0; i < count; ++i)
+		threads[i].Join();
+}
@@ -0,0 +1,18 @@
+#include <System/Time.h>
+#include <time.h>
+
+uint64_t Time::Now()
+{
+	// Use the monotonic clock so that wall clock adjustments don't affect timings
+
+	timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return uint64_t(now.tv_sec) * 1000000000ull + uint64_t(now.tv_nsec);
+}
+
+float Time::Elapsed(uint64_t begin, uint64_t end)
+{
+	return float(double(end - begin) * 1e-9);
+}
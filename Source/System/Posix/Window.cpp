@@ -0,0 +1,85 @@
+#include <System/Window.h>
+#include <Core/Assert.h>
+#include <Core/Log.h>
+
+// There is no windowing backend on POSIX hosts, so windows are never valid and rendering must be
+// driven without a display.
+
+Window::Window(const char* name, uint w, uint h) :
+	w(w), h(h)
+{
+	LOG_ERROR("Failed to create window '%s' (no display support on this platform)", name);
+}
+
+Window::~Window()
+{
+	Close();
+}
+
+void Window::AddMessage(const Message& message)
+{
+	ASSERT(write < countof(messages));
+
+	messages[write++] = message;
+}
+
+bool Window::ReadMessage(Message& message)
+{
+	if (read >= write)
+		return false;
+
+	message = messages[read++];
+
+	return true;
+}
+
+bool Window::Update()
+{
+	ASSERT(read == write, "Messages for the previous update were not fully processed");
+
+	read = write = 0;
+
+	return window != nullptr;
+}
+
+void Window::Close()
+{
+	window = nullptr;
+}
+
+void Window::Blit(void* texels, int sw, int sh) const
+{
+	unused(texels);
+	unused(sw);
+	unused(sh);
+}
+
+void Window::Blit(void* texels, int sx, int sy, int sw, int sh) const
+{
+	unused(texels);
+	unused(sx);
+	unused(sy);
+	unused(sw);
+	unused(sh);
+}
+
+bool Window::Capture(void* texels, int sw, int sh) const
+{
+	unused(texels);
+	unused(sw);
+	unused(sh);
+
+	LOG_ERROR("Failed to capture window buffer");
+
+	return false;
+}
+
+bool Window::HasFocus() const
+{
+	return false;
+}
+
+bool Window::IsValid() const
+{
+	return window != nullptr;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+namespace Process
+{
+	// Start another instance of the current executable with the given arguments (excluding the
+	// program name) and return without waiting for it
+	//
+	bool SpawnSelf(const char* const* args, int count);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <Core/Types.h>
+
+struct Socket
+{
+	Socket() = default;
+
+	Socket(const Socket&) = delete;
+	Socket& operator=(const Socket&) = delete;
+
+	Socket(Socket&& other) noexcept;
+	Socket& operator=(Socket&& other) noexcept;
+
+	~Socket();
+
+	// Listen for TCP connections on the port on all interfaces
+	//
+	bool Listen(int port);
+
+	// Accept a pending connection on a listening socket
+	//
+	bool Accept(Socket& connection) const;
+
+	// Connect to a host name or address and port
+	//
+	bool Connect(const char* host, int port);
+
+	// Wait up to the timeout for a pending connection or incoming data. Returns true if ready
+	//
+	bool Poll(int ms) const;
+
+	// Send all of the data. Returns false if the connection is lost
+	//
+	bool Send(const void* data, size_t size) const;
+
+	// Receive exactly size bytes. Returns false if the connection is lost or closed
+	//
+	bool Receive(void* data, size_t size) const;
+
+	// Close the socket
+	//
+	void Close();
+
+	// Return true if the socket is open
+	//
+	bool IsOpen() const;
+
+	// The native socket
+	//
+	void* handle = nullptr;
+};
@@ -1,9 +1,59 @@
 #pragma once
 
 #include <Core/HeapAllocator.h>
+#include <Core/Memory.h>
 
+// Heap over memory mapped from the system in one block
+//
 struct SystemAllocator : HeapAllocator
 {
+	struct Settings
+	{
+		// Back the heap with huge pages where the system allows it, to cut the TLB misses on
+		// random access to textures and scene data
+		//
+		bool huge_pages = true;
+
+		// Spread the heap across the NUMA nodes a page at a time, so that threads on every node
+		// see the same average latency to the scene data
+		//
+		bool interleave = false;
+	};
+
+	// Memory mapped for the heap and the size of the pages backing it
+	//
+	struct Mapping
+	{
+		void* memory = nullptr;
+		size_t page_size = 0;
+	};
+
 	SystemAllocator(size_t size);
+	SystemAllocator(size_t size, const Settings& settings);
+	SystemAllocator(const Mapping& mapping, size_t size);
 	~SystemAllocator();
+
+	// Size of the pages backing the heap
+	//
+	size_t page_size = 0;
+};
+
+// Allocator that maps each allocation directly from the system in whole pages, so that large
+// blocks are returned to the system as soon as they are freed. Not thread safe on its own.
+//
+struct PageAllocator : Allocator
+{
+	~PageAllocator();
+
+	// Allocate raw aligned memory
+	//
+	void* Allocate(size_t size, size_t alignment) override;
+
+	// Deallocate memory
+	//
+	void Deallocate(void* allocation) override;
+
+	// Tag the pages are accounted to. Pages aren't in a heap, so they're accounted here.
+	//
+	Memory::Tag tag = Memory::Tag::Other;
 };
\ No newline at end of file
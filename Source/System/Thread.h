@@ -1,8 +1,14 @@
 #pragma once
 
+#ifdef _WIN32
+#define THREAD_ENTRY __stdcall
+#else
+#define THREAD_ENTRY
+#endif
+
 struct Thread
 {
-	using EntryPoint = unsigned long(__stdcall*)(void*);
+	using EntryPoint = unsigned long(THREAD_ENTRY*)(void*);
 
 	Thread() = default;
 	Thread(EntryPoint entry_point, void* parameter);
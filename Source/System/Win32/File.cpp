@@ -1,5 +1,6 @@
 #include <System/File.h>
 #include <System/Windows.h>
+#include <Core/Constants.h>
 #include <Core/Log.h>
 
 #ifdef _WIN64
@@ -74,9 +75,60 @@ bool File::OpenForWrite(const char* filename, size_t filesize)
 	return true;
 }
 
-bool File::OpenForRead(const char* filename)
+bool File::OpenForStreaming(const char* filename)
 {
-	file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	file = HANDLE(CreateFileA(filename, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr));
+
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		LOG_ERROR("[%i] Couldn't create file handle for %s", GetLastError(), filename);
+		file = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+bool File::WriteAt(uint64_t offset, const void* data, size_t size) const
+{
+	const uint8_t* head = static_cast<const uint8_t*>(data);
+
+	while (size > 0)
+	{
+		// WriteFile takes 32 bit sizes, so write very large blocks in pieces
+
+		const DWORD chunk = DWORD(size < 1_GiB ? size : 1_GiB);
+
+		OVERLAPPED overlapped = {};
+		overlapped.Offset = DWORD(offset);
+		overlapped.OffsetHigh = DWORD(offset >> 32);
+
+		DWORD written = 0;
+
+		if (!WriteFile(file, head, chunk, &written, &overlapped) || written == 0)
+		{
+			LOG_ERROR("[%i] Couldn't write %zu bytes at offset %llu", GetLastError(), size, offset);
+			return false;
+		}
+
+		head += written;
+		offset += written;
+		size -= written;
+	}
+
+	return true;
+}
+
+bool File::OpenForRead(const char* filename, Access access)
+{
+	const DWORD hints[] =
+	{
+		FILE_ATTRIBUTE_NORMAL,		// Normal
+		FILE_FLAG_SEQUENTIAL_SCAN,	// Sequential
+		FILE_FLAG_RANDOM_ACCESS,	// Random
+	};
+
+	file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, hints[int(access)], nullptr);
 
 	if (file == INVALID_HANDLE_VALUE)
 	{
@@ -161,3 +213,21 @@ void File::Close()
 		file = nullptr;
 	}
 }
+
+bool File::Exists(const char* filename)
+{
+	const DWORD attributes = GetFileAttributesA(filename);
+
+	return attributes != INVALID_FILE_ATTRIBUTES && !(attributes & FILE_ATTRIBUTE_DIRECTORY);
+}
+
+bool File::Replace(const char* from, const char* to)
+{
+	if (!MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+	{
+		LOG_ERROR("[%i] Couldn't move %s to %s", GetLastError(), from, to);
+		return false;
+	}
+
+	return true;
+}
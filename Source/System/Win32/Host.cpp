@@ -0,0 +1,44 @@
+#include <System/Host.h>
+#include <System/Windows.h>
+#include <psapi.h>
+
+#pragma comment(lib, "psapi.lib")
+
+int Host::GetCpuCoreCount()
+{
+	SYSTEM_INFO sysinfo;
+
+	GetSystemInfo(&sysinfo);
+
+	return sysinfo.dwNumberOfProcessors;
+}
+
+int Host::GetNumaNodeCount()
+{
+	ULONG highest = 0;
+
+	if (!GetNumaHighestNodeNumber(&highest))
+		return 1;
+
+	return int(highest) + 1;
+}
+
+int Host::GetNumaNode(int cpu)
+{
+	UCHAR node = 0;
+
+	if (!GetNumaProcessorNode(UCHAR(cpu), &node) || node == 0xff)
+		return 0;
+
+	return node;
+}
+
+size_t Host::GetPeakMemoryUsage()
+{
+	PROCESS_MEMORY_COUNTERS counters;
+
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return 0;
+
+	return counters.PeakWorkingSetSize;
+}
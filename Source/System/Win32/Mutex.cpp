@@ -0,0 +1,25 @@
+#include <System/Mutex.h>
+#include <System/Windows.h>
+
+// Slim reader/writer locks are pointer-sized, so store the lock directly in the handle
+
+static_assert(sizeof(SRWLOCK) == sizeof(void*), "Mutex handle can't hold a slim reader/writer lock");
+
+Mutex::Mutex()
+{
+	InitializeSRWLock(reinterpret_cast<PSRWLOCK>(&handle));
+}
+
+Mutex::~Mutex()
+{
+}
+
+void Mutex::Lock()
+{
+	AcquireSRWLockExclusive(reinterpret_cast<PSRWLOCK>(&handle));
+}
+
+void Mutex::Unlock()
+{
+	ReleaseSRWLockExclusive(reinterpret_cast<PSRWLOCK>(&handle));
+}
@@ -0,0 +1,45 @@
+#include <System/PerfCounters.h>
+
+// There's no user mode access to hardware counters on Windows without a driver, so none are
+// ever available
+
+PerfCounters::~PerfCounters()
+{
+	Close();
+}
+
+bool PerfCounters::Open()
+{
+	return false;
+}
+
+void PerfCounters::Close()
+{
+	for (void*& handle : handles)
+		handle = nullptr;
+}
+
+void PerfCounters::Read(uint64_t* values)
+{
+	for (int i = 0; i < counter_count; ++i)
+		values[i] = 0;
+}
+
+bool PerfCounters::IsAvailable(Counter counter) const
+{
+	return handles[int(counter)] != nullptr;
+}
+
+const char* PerfCounters::GetName(Counter counter)
+{
+	static const char* const names[counter_count] =
+	{
+		"cycles",
+		"instructions",
+		"cache misses",
+		"branch misses",
+		"backend stalls",
+	};
+
+	return names[int(counter)];
+}
@@ -0,0 +1,67 @@
+#include <System/Process.h>
+#include <System/Windows.h>
+#include <Core/Log.h>
+#include <cstring>
+
+bool Process::SpawnSelf(const char* const* args, int count)
+{
+	char path[MAX_PATH];
+
+	if (!GetModuleFileNameA(nullptr, path, sizeof(path)))
+	{
+		LOG_ERROR("[%i] Failed to find the current executable", GetLastError());
+		return false;
+	}
+
+	// Build a quoted command line, starting with the program name
+
+	char command[4096];
+
+	size_t length = 0;
+
+	const auto append = [&](const char* text)
+	{
+		const size_t size = strlen(text);
+
+		if (length + size + 4 > sizeof(command))
+			return false;
+
+		if (length > 0)
+			command[length++] = ' ';
+
+		command[length++] = '"';
+		memcpy(command + length, text, size);
+		length += size;
+		command[length++] = '"';
+		command[length] = 0;
+
+		return true;
+	};
+
+	bool fits = append(path);
+
+	for (int i = 0; i < count; ++i)
+		fits = fits && append(args[i]);
+
+	if (!fits)
+	{
+		LOG_ERROR("Command line is too long to start %s", path);
+		return false;
+	}
+
+	STARTUPINFOA startup = {};
+	PROCESS_INFORMATION process = {};
+
+	startup.cb = sizeof(startup);
+
+	if (!CreateProcessA(path, command, nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startup, &process))
+	{
+		LOG_ERROR("[%i] Failed to start %s", GetLastError(), path);
+		return false;
+	}
+
+	CloseHandle(process.hThread);
+	CloseHandle(process.hProcess);
+
+	return true;
+}
@@ -0,0 +1,239 @@
+#include <System/Socket.h>
+#include <Core/Log.h>
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <cstdio>
+
+#pragma comment(lib, "ws2_32.lib")
+
+namespace
+{
+	struct Winsock
+	{
+		Winsock()
+		{
+			WSADATA data;
+
+			initialized = WSAStartup(MAKEWORD(2, 2), &data) == 0;
+
+			if (!initialized)
+				LOG_ERROR("[%i] Failed to initialize Winsock", WSAGetLastError());
+		}
+
+		~Winsock()
+		{
+			if (initialized)
+				WSACleanup();
+		}
+
+		bool initialized = false;
+	};
+
+	bool Initialize()
+	{
+		static Winsock winsock;
+		return winsock.initialized;
+	}
+
+	// The handle stores the socket offset by one so that a null handle means there is no socket
+
+	void* ToHandle(SOCKET s)
+	{
+		return reinterpret_cast<void*>(s + 1);
+	}
+
+	SOCKET ToSocket(void* handle)
+	{
+		return reinterpret_cast<SOCKET>(handle) - 1;
+	}
+}
+
+Socket::Socket(Socket&& other) noexcept : handle(other.handle)
+{
+	other.handle = nullptr;
+}
+
+Socket& Socket::operator=(Socket&& other) noexcept
+{
+	Close();
+
+	handle = other.handle;
+
+	other.handle = nullptr;
+
+	return *this;
+}
+
+Socket::~Socket()
+{
+	Close();
+}
+
+bool Socket::Listen(int port)
+{
+	Close();
+
+	if (!Initialize())
+		return false;
+
+	const SOCKET s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+	if (s == INVALID_SOCKET)
+	{
+		LOG_ERROR("[%i] Failed to create socket", WSAGetLastError());
+		return false;
+	}
+
+	handle = ToHandle(s);
+
+	sockaddr_in address = {};
+
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+	address.sin_port = htons(u_short(port));
+
+	if (bind(s, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR || listen(s, SOMAXCONN) == SOCKET_ERROR)
+	{
+		LOG_ERROR("[%i] Failed to listen on port %i", WSAGetLastError(), port);
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+bool Socket::Accept(Socket& connection) const
+{
+	const SOCKET s = accept(ToSocket(handle), nullptr, nullptr);
+
+	if (s == INVALID_SOCKET)
+	{
+		LOG_ERROR("[%i] Failed to accept connection", WSAGetLastError());
+		return false;
+	}
+
+	const BOOL nodelay = TRUE;
+
+	setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&nodelay), sizeof(nodelay));
+
+	connection.Close();
+	connection.handle = ToHandle(s);
+
+	return true;
+}
+
+bool Socket::Connect(const char* host, int port)
+{
+	Close();
+
+	if (!Initialize())
+		return false;
+
+	char service[16];
+
+	snprintf(service, sizeof(service), "%i", port);
+
+	addrinfo hints = {};
+
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_protocol = IPPROTO_TCP;
+
+	addrinfo* addresses = nullptr;
+
+	if (getaddrinfo(host, service, &hints, &addresses) != 0)
+	{
+		LOG_ERROR("[%i] Failed to resolve %s", WSAGetLastError(), host);
+		return false;
+	}
+
+	for (const addrinfo* a = addresses; a; a = a->ai_next)
+	{
+		const SOCKET s = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+
+		if (s == INVALID_SOCKET)
+			continue;
+
+		if (connect(s, a->ai_addr, int(a->ai_addrlen)) == 0)
+		{
+			handle = ToHandle(s);
+			break;
+		}
+
+		closesocket(s);
+	}
+
+	freeaddrinfo(addresses);
+
+	if (!handle)
+	{
+		LOG_ERROR("[%i] Failed to connect to %s:%i", WSAGetLastError(), host, port);
+		return false;
+	}
+
+	const BOOL nodelay = TRUE;
+
+	setsockopt(ToSocket(handle), IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&nodelay), sizeof(nodelay));
+
+	return true;
+}
+
+bool Socket::Poll(int ms) const
+{
+	WSAPOLLFD fd = {};
+
+	fd.fd = ToSocket(handle);
+	fd.events = POLLRDNORM;
+
+	return WSAPoll(&fd, 1, ms) > 0;
+}
+
+bool Socket::Send(const void* data, size_t size) const
+{
+	const char* head = static_cast<const char*>(data);
+
+	while (size > 0)
+	{
+		const int sent = send(ToSocket(handle), head, int(size < 0x40000000 ? size : 0x40000000), 0);
+
+		if (sent == SOCKET_ERROR)
+			return false;
+
+		head += sent;
+		size -= sent;
+	}
+
+	return true;
+}
+
+bool Socket::Receive(void* data, size_t size) const
+{
+	char* head = static_cast<char*>(data);
+
+	while (size > 0)
+	{
+		const int received = recv(ToSocket(handle), head, int(size < 0x40000000 ? size : 0x40000000), 0);
+
+		if (received == SOCKET_ERROR || received == 0)
+			return false;
+
+		head += received;
+		size -= received;
+	}
+
+	return true;
+}
+
+void Socket::Close()
+{
+	if (handle)
+	{
+		closesocket(ToSocket(handle));
+		handle = nullptr;
+	}
+}
+
+bool Socket::IsOpen() const
+{
+	return handle != nullptr;
+}
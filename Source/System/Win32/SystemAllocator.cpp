@@ -0,0 +1,169 @@
+#include <System/SystemAllocator.h>
+#include <System/Windows.h>
+#include <System/Host.h>
+#include <Core/Constants.h>
+#include <Core/Assert.h>
+#include <Core/Generic.h>
+#include <Core/Log.h>
+
+#pragma comment(lib, "advapi32.lib")
+
+namespace
+{
+	// Size of the chunks committed to each node in turn when interleaving
+	//
+	constexpr size_t interleave_size = 2_MiB;
+
+	size_t GetPageSize()
+	{
+		SYSTEM_INFO sysinfo;
+
+		GetSystemInfo(&sysinfo);
+
+		return sysinfo.dwPageSize;
+	}
+
+	// Large pages need the lock pages in memory privilege, which the account has to be granted
+	// and the process has to enable
+	//
+	bool EnableLockMemoryPrivilege()
+	{
+		HANDLE token;
+
+		if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+			return false;
+
+		TOKEN_PRIVILEGES privileges = {};
+		privileges.PrivilegeCount = 1;
+		privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+
+		// AdjustTokenPrivileges succeeds without enabling anything if the privilege wasn't granted
+
+		const bool enabled =
+			LookupPrivilegeValue(nullptr, SE_LOCK_MEMORY_NAME, &privileges.Privileges[0].Luid) &&
+			AdjustTokenPrivileges(token, FALSE, &privileges, 0, nullptr, nullptr) &&
+			GetLastError() == ERROR_SUCCESS;
+
+		CloseHandle(token);
+
+		return enabled;
+	}
+
+	SystemAllocator::Mapping Map(size_t size, const SystemAllocator::Settings& settings)
+	{
+		SystemAllocator::Mapping mapping;
+
+		const int nodes = Host::GetNumaNodeCount();
+
+		// Windows has no interleave policy, so reserve the heap and commit it in chunks that
+		// prefer each node in turn. Large pages have to be committed all at once, so they can't
+		// be interleaved.
+
+		if (settings.interleave && nodes > 1)
+		{
+			mapping.memory = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_TOP_DOWN, PAGE_READWRITE);
+			mapping.page_size = GetPageSize();
+
+			CRITICAL(mapping.memory, "Failed to reserve %llu bytes of system memory", (unsigned long long)size);
+
+			for (size_t offset = 0, chunk = 0; offset < size; offset += interleave_size, ++chunk)
+			{
+				void* committed = VirtualAllocExNuma(GetCurrentProcess(), static_cast<uint8_t*>(mapping.memory) + offset, Min(interleave_size, size - offset), MEM_COMMIT, PAGE_READWRITE, DWORD(chunk % nodes));
+
+				CRITICAL(committed, "Failed to commit system memory on NUMA node %i", int(chunk % nodes));
+			}
+
+			LOG_INFO("Create system heap (%iMiB) with small pages, interleaved across %i NUMA nodes", int(size / 1_MiB), nodes);
+
+			return mapping;
+		}
+
+		if (settings.interleave)
+			LOG_WARNING("System memory can't be interleaved, there is only one NUMA node");
+
+		const size_t large_page_size = GetLargePageMinimum();
+
+		if (settings.huge_pages && large_page_size > 0 && size % large_page_size == 0 && EnableLockMemoryPrivilege())
+		{
+			mapping.memory = VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE | MEM_LARGE_PAGES, PAGE_READWRITE);
+			mapping.page_size = large_page_size;
+		}
+
+		if (!mapping.memory)
+		{
+			mapping.memory = VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE | MEM_TOP_DOWN, PAGE_READWRITE);
+			mapping.page_size = GetPageSize();
+		}
+
+		CRITICAL(mapping.memory, "Failed to map %llu bytes of system memory", (unsigned long long)size);
+
+		LOG_INFO("Create system heap (%iMiB) with %iKiB pages", int(size / 1_MiB), int(mapping.page_size / 1_KiB));
+
+		return mapping;
+	}
+}
+
+SystemAllocator::SystemAllocator(size_t size) : SystemAllocator(size, Settings())
+{
+}
+
+SystemAllocator::SystemAllocator(size_t size, const Settings& settings) : SystemAllocator(Map(size, settings), size)
+{
+}
+
+SystemAllocator::SystemAllocator(const Mapping& mapping, size_t size) : HeapAllocator(mapping.memory, size), page_size(mapping.page_size)
+{
+}
+
+SystemAllocator::~SystemAllocator()
+{
+	ASSERT(IsEmpty(), "Heap has outstanding allocations");
+
+	VirtualFree(memory, 0, MEM_RELEASE);
+
+	// The system memory may be overwritten with a memory pattern, so clear out the memory
+	// pointer so that the heap destructor doesn't try to read bad data.
+
+	memory = nullptr;
+	head = nullptr;
+}
+
+PageAllocator::~PageAllocator()
+{
+	ASSERT(allocated == 0, "Pages have outstanding allocations");
+}
+
+void* PageAllocator::Allocate(size_t size, size_t alignment)
+{
+	// VirtualAlloc places allocations on the allocation granularity, which is 64 KiB
+
+	ASSERT(alignment <= 64 * 1024, "Page allocations can't be aligned beyond 64 KiB");
+
+	void* allocation = VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+
+	CRITICAL(allocation, "Failed to map %llu bytes of system memory", (unsigned long long)size);
+
+	MEMORY_BASIC_INFORMATION information;
+	VirtualQuery(allocation, &information, sizeof(information));
+
+	AddAllocated(information.RegionSize);
+	Memory::OnAllocate(tag, information.RegionSize);
+
+	return allocation;
+}
+
+void PageAllocator::Deallocate(void* allocation)
+{
+	if (!allocation)
+		return;
+
+	MEMORY_BASIC_INFORMATION information;
+	VirtualQuery(allocation, &information, sizeof(information));
+
+	ASSERT(allocated >= information.RegionSize, "Deallocating pages that were not allocated");
+
+	allocated -= information.RegionSize;
+	Memory::OnDeallocate(tag, information.RegionSize);
+
+	VirtualFree(allocation, 0, MEM_RELEASE);
+}
@@ -34,6 +34,17 @@ namespace
 				window->AddMessage(Message(Message::Type::KeyUp, int(wParam)));
 				break;
 
+			case WM_LBUTTONDOWN:
+				// Keep receiving mouse messages if the cursor is dragged outside the window
+				SetCapture(hWnd);
+				window->AddMessage(Message(Message::Type::MouseDown, int(lParam)));
+				break;
+
+			case WM_LBUTTONUP:
+				ReleaseCapture();
+				window->AddMessage(Message(Message::Type::MouseUp, int(lParam)));
+				break;
+
 			default:
 				break;
 		}
@@ -12,7 +12,13 @@ struct Message
 		Unknown = -1,
 
 		KeyDown,
-		KeyUp
+		KeyUp,
+
+		// The data holds the cursor position in window pixels, with x in the low 16 bits and y
+		// in the high 16 bits, both signed
+		//
+		MouseDown,
+		MouseUp
 	};
 
 	Message() = default;
@@ -2,4 +2,8 @@
 
 #include "Config.h"
 
-#include "Win32/TimeHelpers.h"
+#if defined(UNITTEST_POSIX)
+	#include "Posix/TimeHelpers.h"
+#else
+	#include "Win32/TimeHelpers.h"
+#endif